@@ -0,0 +1,115 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <X11/Xlib.h>
+
+#include "arrange.h"
+
+#include "client.h"
+#include "debug.h"
+#include "dwm.h"
+#include "util.h"
+
+//******************************************************************************
+// Module types
+//******************************************************************************
+struct arrange_geom {
+	struct Client *c;
+	int x, y, w, h;
+};
+
+struct arrange_txn {
+	bool open;
+	int size;
+	int capacity;
+	struct arrange_geom *geoms;
+};
+
+//******************************************************************************
+// Module variables
+//******************************************************************************
+// The storage is kept between transactions, arranging does not allocate once
+// it has grown to the largest tagview.
+static struct arrange_txn txn;
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static void capacity_ensure(struct arrange_txn *t, int capacity);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+struct arrange_txn *arrange_txn_begin(int n_clients)
+{
+	assert(!txn.open);
+
+	capacity_ensure(&txn, n_clients);
+	txn.size = 0;
+	txn.open = true;
+	return &txn;
+}
+
+void arrange_geom_set(
+	struct arrange_txn *t,
+	struct Client *c,
+	int x, int y, int w, int h)
+{
+	assert(t->open);
+
+	capacity_ensure(t, t->size + 1);
+	t->geoms[t->size++] = (struct arrange_geom) {
+		.c = c,
+		.x = x,
+		.y = y,
+		.w = w,
+		.h = h
+	};
+}
+
+int arrange_txn_commit(struct arrange_txn *t)
+{
+	int n_configured = 0;
+
+	assert(t->open);
+
+	for (int i = 0; i < t->size; i++) {
+		struct arrange_geom *g = &t->geoms[i];
+
+		// Size hints are applied against the current geometry, and
+		// tell if anything changed.
+		if (applysizehints(g->c, &g->x, &g->y, &g->w, &g->h, 0)) {
+			client_geom_configure(g->c, g->x, g->y, g->w, g->h);
+			n_configured++;
+		}
+	}
+
+	if (n_configured > 0) {
+		XFlush(dpy);
+	}
+	P_DEBUG("%s: %d of %d clients configured\n", __func__, n_configured, t->size);
+
+	t->open = false;
+	return n_configured;
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static void capacity_ensure(struct arrange_txn *t, int capacity)
+{
+	if (capacity <= t->capacity) {
+		return;
+	}
+
+	int new_capacity = MAX(capacity, 2 * t->capacity);
+	struct arrange_geom *geoms = realloc(
+		t->geoms,
+		new_capacity * sizeof(*geoms));
+
+	if (geoms == NULL) {
+		die("realloc:");
+	}
+	t->geoms = geoms;
+	t->capacity = new_capacity;
+}
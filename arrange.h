@@ -0,0 +1,36 @@
+#ifndef ARRANGE_H
+#define ARRANGE_H
+
+#include "client.h"
+
+// An arrange transaction collects the geometries a layout computes for its
+// clients, and applies them all at once: only clients whose geometry actually
+// changes get a ConfigureWindow request, and the requests are flushed once at
+// the end instead of syncing with the X server for every client.
+
+struct arrange_txn;
+
+//  ----------------------------------------------------------------------------
+/// \brief  Start a transaction. Only one transaction may be open at a time.
+/// \param  n_clients  Expected number of clients, to size the storage.
+/// \return The transaction to pass to the layout.
+//  ----------------------------------------------------------------------------
+struct arrange_txn *arrange_txn_begin(int n_clients);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Record the geometry computed by a layout for a client. Same
+/// arguments as resize(), without interaction.
+//  ----------------------------------------------------------------------------
+void arrange_geom_set(
+	struct arrange_txn *txn,
+	struct Client *c,
+	int x, int y, int w, int h);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Apply the size hints to all recorded geometries, configure the
+/// clients whose geometry changed, and close the transaction.
+/// \return Number of clients that were configured.
+//  ----------------------------------------------------------------------------
+int arrange_txn_commit(struct arrange_txn *txn);
+
+#endif
@@ -27,6 +27,27 @@ void bar_draw(struct Monitor *m);
 
 void bar_draw_all_mons(struct list *mons);
 
+//  ----------------------------------------------------------------------------
+/// \brief  Read the status text from the root window name, see
+/// bar_status_set().
+//  ----------------------------------------------------------------------------
 void bar_status_update(void);
 
+//  ----------------------------------------------------------------------------
+/// \brief  Set the status text, and schedule drawing the bar of the selected
+/// monitor. Nothing is scheduled if the text did not change.
+//  ----------------------------------------------------------------------------
+void bar_status_set(const char *text);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Forget what the bar of a monitor shows, e.g. after an Expose, so
+/// the next bar_draw() redraws it completely.
+//  ----------------------------------------------------------------------------
+void bar_damage(struct Monitor *m);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Free what the bar backend keeps for a monitor.
+//  ----------------------------------------------------------------------------
+void bar_mon_free(struct Monitor *m);
+
 #endif
@@ -2,6 +2,8 @@
 #include "dm.h"
 #include "dwm.h"
 #include "monitor.h"
+#include <stdio.h>
+#include <string.h>
 #include <X11/Xatom.h>
 
 //******************************************************************************
@@ -36,9 +38,28 @@ void bar_draw_all_mons(struct list *mons)
 
 void bar_status_update(void)
 {
-	if (!dm_gettextprop(root, XA_WM_NAME, status_text, sizeof(status_text)))
-		strcpy(status_text, "dwm-"VERSION);
-	bar_draw(selmon);
+	char text[sizeof(status_text)];
+
+	if (!dm_gettextprop(root, XA_WM_NAME, text, sizeof(text)))
+		strcpy(text, "dwm-"VERSION);
+	bar_status_set(text);
+}
+
+void bar_status_set(const char *text)
+{
+	if (strncmp(text, status_text, sizeof(status_text) - 1) == 0) {
+		return;
+	}
+	snprintf(status_text, sizeof(status_text), "%s", text);
+	mon_bar_schedule(selmon);
+}
+
+void bar_damage(struct Monitor *m)
+{
+}
+
+void bar_mon_free(struct Monitor *m)
+{
 }
 
 //******************************************************************************
@@ -0,0 +1,298 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xatom.h>
+
+#include "bar.h"
+#include "client.h"
+#include "debug.h"
+#include "dm.h"
+#include "drw.h"
+#include "dwm.h"
+#include "monitor.h"
+#include "tagview.h"
+#include "util.h"
+
+// Bar drawing by zones. Each monitor keeps, for every zone, the inputs it was
+// last drawn from and where it was drawn. bar_draw() only renders the zones
+// whose inputs or extent changed, and copies each of them to the bar window on
+// its own: a new status text touches the status zone only, a new title the
+// title zone only.
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+#define STATUS_SIZE 256 // Size of stext
+
+//******************************************************************************
+// Module types
+//******************************************************************************
+// Everything a zone is drawn from. Compared with memcmp(), it must be zeroed
+// before filling in.
+struct zone_key {
+	char text[256];
+	int scheme;
+	unsigned int occupied; // Tags zone: one bit per tag
+	unsigned int urgent;   // Tags zone: one bit per tag
+	int shown_tag;         // Tags zone: tagview shown on the monitor
+	bool has_client;
+	bool isfloating;
+	bool isfixed;
+};
+
+struct zone {
+	bool valid;
+	int x, w;
+	struct zone_key key;
+};
+
+struct bar_state {
+	struct zone zones[BAR_ZONE_STATUS + 1];
+};
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static struct bar_state *state_get(struct Monitor *m);
+static int text_w(const char *text);
+static int tags_w(void);
+static void keys_get(struct Monitor *m, struct zone_key keys[], int x[], int w[]);
+static void zone_render(
+	struct Monitor *m,
+	enum bar_zone zone,
+	const struct zone_key *key,
+	int x,
+	int w);
+static void callback_bar_draw(void *monitor, void *storage);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+enum bar_zone
+bar_x_to_zone(int x)
+{
+	struct bar_state *s = selmon->bar;
+
+	if (s == NULL) {
+		return BAR_ZONE_NONE;
+	}
+	for (int z = BAR_ZONE_TAGS; z <= BAR_ZONE_STATUS; z++) {
+		if (s->zones[z].valid
+		    && x >= s->zones[z].x
+		    && x < s->zones[z].x + s->zones[z].w) {
+			return z;
+		}
+	}
+	return BAR_ZONE_NONE;
+}
+
+void bar_draw(struct Monitor *m)
+{
+	struct bar_state *s;
+	struct zone_key keys[BAR_ZONE_STATUS + 1];
+	int x[BAR_ZONE_STATUS + 1];
+	int w[BAR_ZONE_STATUS + 1];
+	P_INT(n_drawn = 0);
+
+	if (m == NULL || !m->showbar || m->barwin == None) {
+		return;
+	}
+
+	s = state_get(m);
+	keys_get(m, keys, x, w);
+	for (int z = BAR_ZONE_TAGS; z <= BAR_ZONE_STATUS; z++) {
+		struct zone *zone = &s->zones[z];
+
+		if (zone->valid
+		    && zone->x == x[z]
+		    && zone->w == w[z]
+		    && memcmp(&zone->key, &keys[z], sizeof(keys[z])) == 0) {
+			continue;
+		}
+
+		zone->valid = true;
+		zone->x = x[z];
+		zone->w = w[z];
+		zone->key = keys[z];
+		if (w[z] > 0) {
+			zone_render(m, z, &keys[z], x[z], w[z]);
+			drw_map(drw, m->barwin, x[z], 0, w[z], bar_h);
+#if defined(DEBUG)
+			n_drawn++;
+#endif
+		}
+	}
+	P_DEBUG("%s: %p, %d zones drawn\n", __func__, (void *) m, n_drawn);
+}
+
+void bar_draw_all_mons(struct list *mons)
+{
+	list_run_for_all(mons, callback_bar_draw, NULL);
+}
+
+void bar_status_update(void)
+{
+	char text[STATUS_SIZE];
+
+	if (!dm_gettextprop(root, XA_WM_NAME, text, sizeof(text)))
+		strcpy(text, "dwm-"VERSION);
+	bar_status_set(text);
+}
+
+void bar_status_set(const char *text)
+{
+	if (strncmp(text, stext, STATUS_SIZE - 1) == 0) {
+		return;
+	}
+	snprintf(stext, STATUS_SIZE, "%s", text);
+	mon_bar_schedule(selmon);
+}
+
+void bar_damage(struct Monitor *m)
+{
+	if (m->bar == NULL) {
+		return;
+	}
+	for (int z = BAR_ZONE_TAGS; z <= BAR_ZONE_STATUS; z++) {
+		m->bar->zones[z].valid = false;
+	}
+}
+
+void bar_mon_free(struct Monitor *m)
+{
+	free(m->bar);
+	m->bar = NULL;
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static struct bar_state *state_get(struct Monitor *m)
+{
+	if (m->bar == NULL) {
+		m->bar = ecalloc(1, sizeof(*m->bar));
+	}
+	return m->bar;
+}
+
+static int text_w(const char *text)
+{
+	return drw_fontset_getwidth(drw, text) + lrpad;
+}
+
+static int tags_w(void)
+{
+	int w = 0;
+
+	for (int i = 0; i < num_tags && tags[i] != NULL; i++) {
+		w += text_w(tags[i]);
+	}
+	return w;
+}
+
+// The zones from left to right: tags, layout symbol, title, and the status
+// text on the selected monitor only.
+static void keys_get(struct Monitor *m, struct zone_key keys[], int x[], int w[])
+{
+	struct Client *c = mon_selected_client_get(m);
+	struct Client *tv_c;
+
+	memset(keys, 0, (BAR_ZONE_STATUS + 1) * sizeof(keys[0]));
+
+	for (int i = 0; i < num_tags && tags[i] != NULL; i++) {
+		struct tagview *tv = tagview_get(i);
+
+		if (tv->clients.size > 0) {
+			keys[BAR_ZONE_TAGS].occupied |= 1u << i;
+		}
+		TAGVIEW_FOR_EACH_CLIENT(tv_c, tv) {
+			if (tv_c->isurgent) {
+				keys[BAR_ZONE_TAGS].urgent |= 1u << i;
+				break;
+			}
+		}
+	}
+	keys[BAR_ZONE_TAGS].shown_tag = m->tagview->index;
+	keys[BAR_ZONE_TAGS].has_client = m == selmon && c != NULL;
+	x[BAR_ZONE_TAGS] = 0;
+	w[BAR_ZONE_TAGS] = tags_w();
+
+	strcpy(keys[BAR_ZONE_LAYOUT].text, m->ltsymbol);
+	x[BAR_ZONE_LAYOUT] = x[BAR_ZONE_TAGS] + w[BAR_ZONE_TAGS];
+	w[BAR_ZONE_LAYOUT] = text_w(m->ltsymbol);
+
+	if (m == selmon) {
+		strcpy(keys[BAR_ZONE_STATUS].text, stext);
+		w[BAR_ZONE_STATUS] = drw_fontset_getwidth(drw, stext) + 2; // Right padding
+	} else {
+		w[BAR_ZONE_STATUS] = 0;
+	}
+	x[BAR_ZONE_STATUS] = m->ww - w[BAR_ZONE_STATUS];
+
+	keys[BAR_ZONE_WIN_TITLE].scheme = m == selmon ? SchemeSel : SchemeNorm;
+	if (c != NULL) {
+		strcpy(keys[BAR_ZONE_WIN_TITLE].text, c->name);
+		keys[BAR_ZONE_WIN_TITLE].has_client = true;
+		keys[BAR_ZONE_WIN_TITLE].isfloating = c->isfloating;
+		keys[BAR_ZONE_WIN_TITLE].isfixed = c->isfixed;
+	}
+	x[BAR_ZONE_WIN_TITLE] = x[BAR_ZONE_LAYOUT] + w[BAR_ZONE_LAYOUT];
+	w[BAR_ZONE_WIN_TITLE] = MAX(x[BAR_ZONE_STATUS] - x[BAR_ZONE_WIN_TITLE], 0);
+}
+
+static void zone_render(
+	struct Monitor *m,
+	enum bar_zone zone,
+	const struct zone_key *key,
+	int x,
+	int w)
+{
+	int boxs = drw->fonts->h / 9;
+	int boxw = drw->fonts->h / 6 + 2;
+
+	switch (zone) {
+	case BAR_ZONE_TAGS:
+		for (int i = 0; i < num_tags && tags[i] != NULL; i++) {
+			int tw = text_w(tags[i]);
+			bool urgent = key->urgent & 1u << i;
+
+			drw_setscheme(drw, scheme[key->shown_tag == i ? SchemeSel : SchemeNorm]);
+			drw_text(drw, x, 0, tw, bar_h, lrpad / 2, tags[i], urgent);
+			if (key->occupied & 1u << i) {
+				drw_rect(drw, x + boxs, boxs, boxw, boxw,
+					 key->has_client && key->shown_tag == i,
+					 urgent);
+			}
+			x += tw;
+		}
+		break;
+	case BAR_ZONE_LAYOUT:
+		drw_setscheme(drw, scheme[SchemeNorm]);
+		drw_text(drw, x, 0, w, bar_h, lrpad / 2, key->text, 0);
+		break;
+	case BAR_ZONE_WIN_TITLE:
+		if (key->has_client) {
+			drw_setscheme(drw, scheme[key->scheme]);
+			drw_text(drw, x, 0, w, bar_h, lrpad / 2, key->text, 0);
+			if (key->isfloating) {
+				drw_rect(drw, x + boxs, boxs, boxw, boxw, key->isfixed, 0);
+			}
+		} else {
+			drw_setscheme(drw, scheme[SchemeNorm]);
+			drw_rect(drw, x, 0, w, bar_h, 1, 1);
+		}
+		break;
+	case BAR_ZONE_STATUS:
+		drw_setscheme(drw, scheme[SchemeNorm]);
+		drw_text(drw, x, 0, w, bar_h, 0, key->text, 0);
+		break;
+	case BAR_ZONE_NONE:
+		break;
+	}
+}
+
+static void callback_bar_draw(void *monitor, void *storage)
+{
+	bar_draw((struct Monitor *) monitor);
+}
@@ -1,15 +1,20 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include <X11/Xlib.h>
 #include <X11/Xatom.h>
 
 #include "bar.h"
 #include "client.h"
+#include "clientlist.h"
 #include "config.h"
 #include "debug.h"
 #include "dm.h"
 #include "dwm.h"
+#include "ipc.h"
+#include "prefetch.h"
+#include "proc.h"
 #include "util.h"
 
 //******************************************************************************
@@ -20,15 +25,29 @@ static const char broken[] = "broken";
 //******************************************************************************
 // Function prototypes
 //******************************************************************************
-static int applysizehints(Client *c, int *x, int *y, int *w, int *h, int interact);
 static void grab_buttons(struct Client *c, bool focused);
 static void apply_rules(Client *c);
 static Atom atom_prop_get(Client *c, Atom prop);
+static void client_window_type_apply(Client *c, Atom state, Atom wtype);
+static void client_size_hints_apply(Client *c, const XSizeHints *size);
+static void client_wm_hints_apply(Client *c, const XWMHints *wmh);
 
 //******************************************************************************
 // Function definitions
 //******************************************************************************
 void client_create(Window w, XWindowAttributes *wa)
+{
+	struct client_props props;
+
+	// All properties are requested at once, before any is needed.
+	client_props_get(w, &props);
+	client_create_with_props(w, wa, &props);
+}
+
+void client_create_with_props(
+	Window w,
+	XWindowAttributes *wa,
+	const struct client_props *props)
 {
 	Client *c = NULL;
 	struct Monitor *m, *mon_from_transient;
@@ -44,8 +63,9 @@ void client_create(Window w, XWindowAttributes *wa)
 	c->h = c->oldh = wa->height;
 	c->oldbw = wa->border_width;
 
-	client_name_update(c);
-	if (XGetTransientForHint(dpy, w, &trans) && (mon_from_transient = wintomon(trans))) {
+	client_name_set(c, props->name);
+	trans = props->transient_for;
+	if (trans != None && (mon_from_transient = wintomon(trans))) {
 		m = mon_from_transient;
 	} else {
 		m = selmon;
@@ -69,9 +89,10 @@ void client_create(Window w, XWindowAttributes *wa)
 	XConfigureWindow(dpy, w, CWBorderWidth, &wc);
 	XSetWindowBorder(dpy, w, scheme[SchemeNorm][ColBorder].pixel);
 	configure(c); /* propagates border_width, if size doesn't change */
-	client_update_window_type(c);
-	client_update_size_hints(c);
-	client_update_wm_hints(c);
+	client_window_type_apply(c, props->state, props->window_type);
+	client_size_hints_apply(c, props->has_size_hints ? &props->size_hints : NULL);
+	client_wm_hints_apply(c, props->has_wm_hints ? &props->wm_hints : NULL);
+	c->protocols = props->protocols;
 	XSelectInput(
 		dpy,
 		w,
@@ -82,28 +103,25 @@ void client_create(Window w, XWindowAttributes *wa)
 	if (c->isfloating)
 		XRaiseWindow(dpy, c->win);
 	tagview_add_client(m->tagview, c);
-	XChangeProperty(dpy, root, netatom[NetClientList], XA_WINDOW, 32, PropModeAppend,
-			(unsigned char *) &(c->win), 1);
+	clientlist_add(c->win);
 	XMoveResizeWindow(dpy, c->win, c->x + 2 * screen_w, c->y, c->w, c->h); /* some windows require this */
 	client_state_set(c, NormalState);
 	if (m == selmon)
 		client_unfocus(mon_selected_client_get(selmon), 0);
-	mon_arrange(m);
+	mon_arrange_schedule(m);
 	XMapWindow(dpy, c->win);
 	client_focus(c);
+	proc_window_managed(props->pid);
+	ipc_event(IPC_EVENT_CREATE, c->win);
 }
 
-void client_hide(void *client, void *storage)
+void client_hide(struct Client *c)
 {
-	struct Client *c = (struct Client *) client;
-
 	XUnmapWindow(dpy, c->win);
 }
 
-void client_show(void *client, void *storage)
+void client_show(struct Client *c)
 {
-	struct Client *c = (struct Client *) client;
-
 	XMapWindow(dpy, c->win);
 }
 
@@ -123,6 +141,29 @@ void client_name_update(Client *c)
 		strcpy(c->name, broken);
 }
 
+void client_name_set(Client *c, const char *name)
+{
+	strncpy(c->name, name, sizeof(c->name) - 1);
+	c->name[sizeof(c->name) - 1] = '\0';
+	if (c->name[0] == '\0') /* hack to mark broken clients */
+		strcpy(c->name, broken);
+}
+
+void client_protocols_update(Client *c)
+{
+	int n;
+	Atom *protocols;
+
+	c->protocols = 0;
+	if (XGetWMProtocols(dpy, c->win, &protocols, &n)) {
+		while (n--)
+			for (int i = 0; i < WMLast; i++)
+				if (protocols[n] == wmatom[i])
+					c->protocols |= 1U << i;
+		XFree(protocols);
+	}
+}
+
 void client_state_set(Client *c, long state)
 {
 	long data[] = { state, None };
@@ -133,9 +174,14 @@ void client_state_set(Client *c, long state)
 
 void client_update_window_type(Client *c)
 {
-	Atom state = atom_prop_get(c, netatom[NetWMState]);
-	Atom wtype = atom_prop_get(c, netatom[NetWMWindowType]);
+	client_window_type_apply(
+		c,
+		atom_prop_get(c, netatom[NetWMState]),
+		atom_prop_get(c, netatom[NetWMWindowType]));
+}
 
+static void client_window_type_apply(Client *c, Atom state, Atom wtype)
+{
 	if (state == netatom[NetWMFullscreen])
 		client_fullscreen_set(c, 1);
 	if (wtype == netatom[NetWMWindowTypeDialog])
@@ -161,8 +207,12 @@ void client_focus(struct Client *c)
 	grab_buttons(c, true);
 	XSetWindowBorder(dpy, c->win, scheme[SchemeSel][ColBorder].pixel);
 	dm_focus(c);
-	tagview_selected_client_set(selmon->tagview, c);
-	bar_draw_all_mons(&mons);
+	// Its own tagview: a transient may be on another monitor than selmon.
+	if (c->tagview != NULL) {
+		tagview_selected_client_set(c->tagview, c);
+	}
+	list_run_for_all(&mons, mon_bar_schedule_cb, NULL);
+	ipc_event(IPC_EVENT_FOCUS, 0);
 }
 
 void client_unfocus(struct Client *c, bool focus_root)
@@ -200,7 +250,19 @@ void client_update_size_hints(Client *c)
 	XSizeHints size;
 
 	if (!XGetWMNormalHints(dpy, c->win, &size, &msize))
-		/* size is uninitialized, ensure that size.flags aren't used */
+		client_size_hints_apply(c, NULL);
+	else
+		client_size_hints_apply(c, &size);
+}
+
+static void client_size_hints_apply(Client *c, const XSizeHints *hints)
+{
+	XSizeHints size = { 0 };
+
+	if (hints)
+		size = *hints;
+	else
+		/* no hints, ensure that size.flags aren't used */
 		size.flags = PSize;
 	if (size.flags & PBaseSize) {
 		c->basew = size.base_width;
@@ -246,25 +308,34 @@ void client_update_wm_hints(Client *c)
 	XWMHints *wmh;
 
 	if ((wmh = XGetWMHints(dpy, c->win))) {
-		if (c == mon_selected_client_get(selmon) && wmh->flags & XUrgencyHint) {
-			wmh->flags &= ~XUrgencyHint;
-			XSetWMHints(dpy, c->win, wmh);
-		} else {
-			c->isurgent = (wmh->flags & XUrgencyHint) ? 1 : 0;
-		}
-		if (wmh->flags & InputHint)
-			c->neverfocus = !wmh->input;
-		else
-			c->neverfocus = 0;
+		client_wm_hints_apply(c, wmh);
 		XFree(wmh);
 	}
 }
 
+static void client_wm_hints_apply(Client *c, const XWMHints *wmh)
+{
+	if (wmh == NULL)
+		return;
+	if (c == mon_selected_client_get(selmon) && wmh->flags & XUrgencyHint) {
+		XWMHints cleared = *wmh;
+
+		cleared.flags &= ~XUrgencyHint;
+		XSetWMHints(dpy, c->win, &cleared);
+	} else {
+		c->isurgent = (wmh->flags & XUrgencyHint) ? 1 : 0;
+	}
+	if (wmh->flags & InputHint)
+		c->neverfocus = !wmh->input;
+	else
+		c->neverfocus = 0;
+}
+
 //// Keeping this for now, but setting fullscreen should be the
 //// responsibility of a fullscreen layout?
 void client_fullscreen_set(Client *c, bool fullscreen)
 {
-	struct Monitor *m = list_find(&mons, mon_has_client, c);
+	struct Monitor *m = client_mon_get(c);
 
 	if (m == NULL)
 		return;
@@ -279,6 +350,7 @@ void client_fullscreen_set(Client *c, bool fullscreen)
 		c->isfloating = 1;
 		resizeclient(c, m->mx, m->my, m->mw, m->mh);
 		XRaiseWindow(dpy, c->win);
+		clientlist_raise(c->win);
 	} else if (!fullscreen && c->isfullscreen) {
 		XChangeProperty(dpy, c->win, netatom[NetWMState], XA_ATOM, 32,
 				PropModeReplace, (unsigned char *) 0, 0);
@@ -290,7 +362,7 @@ void client_fullscreen_set(Client *c, bool fullscreen)
 		c->w = c->oldw;
 		c->h = c->oldh;
 		resizeclient(c, c->x, c->y, c->w, c->h);
-		mon_arrange(m);
+		mon_arrange_schedule(m);
 	}
 }
 
@@ -313,21 +385,15 @@ configure(Client *c)
 	XSendEvent(dpy, c->win, False, StructureNotifyMask, (XEvent *) &ce);
 }
 
-static bool client_is_on_mon(void *monitor, void *client)
+struct Monitor *client_mon_get(const struct Client *c)
 {
-	struct Monitor *m = (struct Monitor *) monitor;
-	struct Client *c = (struct Client *) client;
-
-	return tagview_has_client(m->tagview, c);
+	return c->tagview == NULL ? NULL : c->tagview->mon;
 }
 
 bool
 isvisible(const Client *c)
 {
-	return list_find(
-		&mons,
-		client_is_on_mon,
-		(void *) c) != NULL;
+	return client_mon_get(c) != NULL;
 }
 
 void
@@ -339,6 +405,12 @@ resize(Client *c, int x, int y, int w, int h, int interact)
 
 void
 resizeclient(Client *c, int x, int y, int w, int h)
+{
+	client_geom_configure(c, x, y, w, h);
+	XSync(dpy, False);
+}
+
+void client_geom_configure(Client *c, int x, int y, int w, int h)
 {
 	XWindowChanges wc;
 
@@ -349,7 +421,6 @@ resizeclient(Client *c, int x, int y, int w, int h)
 	wc.border_width = c->bw;
 	XConfigureWindow(dpy, c->win, CWX | CWY | CWWidth | CWHeight | CWBorderWidth, &wc);
 	configure(c);
-	XSync(dpy, False);
 }
 
 int
@@ -364,14 +435,17 @@ height(const Client *c)
 	return c->h + (2 * c->bw);
 }
 
-//******************************************************************************
-// Internal functions
-//******************************************************************************
-static int
+int
 applysizehints(Client *c, int *x, int *y, int *w, int *h, int interact)
 {
 	int baseismin;
-	Monitor *m = list_find(&mons, mon_has_client, c);
+	Monitor *m = client_mon_get(c);
+
+	if (m == NULL) {
+		// Client in a hidden tagview, constrain it like on the
+		// selected monitor.
+		m = selmon;
+	}
 
 	/* set minimum possible */
 	*w = MAX(1, *w);
@@ -433,24 +507,52 @@ applysizehints(Client *c, int *x, int *y, int *w, int *h, int interact)
 	return *x != c->x || *y != c->y || *w != c->w || *h != c->h;
 }
 
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+
+// Only the requests needed to go from the grabs the client has to the wanted
+// ones are sent. Nothing is sent when focus moves back and forth without
+// changing the state of this client.
+//
+// The grabs cannot be changed more finely than that: the unfocused state grabs
+// AnyButton with AnyModifier, which stands for every button and modifier
+// combination, so it can only be removed by ungrabbing everything. Going to
+// the unfocused state needs no ungrab, the AnyModifier grab replaces all
+// grabs, and the bindings are grabbed again on top of it.
 static void grab_buttons(struct Client *c, bool focused)
 {
 	updatenumlockmask();
 
+	enum client_grab grab = focused ? CLIENT_GRAB_FOCUSED : CLIENT_GRAB_UNFOCUSED;
+
+	if (c->grab == grab && c->grab_numlockmask == numlockmask) {
+		return;
+	}
+
 	unsigned int i, j;
 	unsigned int modifiers[] = { 0, LockMask, numlockmask, numlockmask | LockMask };
-	XUngrabButton(dpy, AnyButton, AnyModifier, c->win);
-	if (!focused)
+	// Without NumLock, the last two combinations repeat the first two.
+	unsigned int n_modifiers = numlockmask ? LENGTH(modifiers) : 2;
+
+	if (focused) {
+		if (c->grab != CLIENT_GRAB_NONE)
+			XUngrabButton(dpy, AnyButton, AnyModifier, c->win);
+	} else {
 		XGrabButton(dpy, AnyButton, AnyModifier, c->win, False,
 			    BUTTONMASK, GrabModeSync, GrabModeSync, None, None);
+	}
 	for (i = 0; i < num_buttons; i++)
 		if (buttons[i].click == ClkClientWin) {
-			for (j = 0; j < LENGTH(modifiers); j++)
+			for (j = 0; j < n_modifiers; j++)
 				XGrabButton(dpy, buttons[i].button,
 					    buttons[i].mask | modifiers[j],
 					    c->win, False, BUTTONMASK,
 					    GrabModeAsync, GrabModeSync, None, None);
 		}
+
+	c->grab = grab;
+	c->grab_numlockmask = numlockmask;
 }
 
 static void apply_rules(Client *c)
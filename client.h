@@ -4,13 +4,23 @@
 #include <stdbool.h>
 #include <X11/Xlib.h>
 
+#include "linkedlist/linkedlist.h"
+
 /* This must come before including header files using the type. */
 typedef struct Client Client;
 
 struct Monitor;
+struct tagview;
+struct client_props;
 
 enum { SchemeNorm, SchemeSel };                         /* color schemes */
 
+enum client_grab {
+	CLIENT_GRAB_NONE, // Must be 0, clients are zero initialized.
+	CLIENT_GRAB_FOCUSED,
+	CLIENT_GRAB_UNFOCUSED
+};
+
 struct Client {
 	char name[256];
 	float mina, maxa;
@@ -28,6 +38,23 @@ struct Client {
 	bool isfixed, isfloating, isurgent, neverfocus, oldstate, isfullscreen;
 
 	Window win;
+
+	// WM_PROTOCOLS supported by the window, bit (1 << i) set for
+	// wmatom[i]. Cached to avoid a round trip for every sendevent().
+	unsigned int protocols;
+
+	// Passive button grabs currently set on the window, and the
+	// numlockmask they were set with, see grab_buttons().
+	enum client_grab grab;
+	unsigned int grab_numlockmask;
+
+	// Back-reference to the tagview holding the client, maintained by
+	// the tagview module. NULL while the client is in no tagview.
+	struct tagview *tagview;
+
+	// Links the client in the clients list of its tagview, an intrusive
+	// list: being in a tagview allocates nothing.
+	struct ll_node tagview_link;
 };
 
 typedef struct {
@@ -41,12 +68,18 @@ typedef struct {
 
 void client_create(Window w, XWindowAttributes *wa);
 
+// Same as client_create(), with the window properties already fetched, see
+// prefetch.h.
+void client_create_with_props(
+	Window w,
+	XWindowAttributes *wa,
+	const struct client_props *props);
+
 void client_focus(struct Client *c);
 void client_unfocus(struct Client *c, bool focus_root);
 
-// These signatures must match that of the callback in list_run_for_all
-void client_hide(void *client, void *storage);
-void client_show(void *client, void *storage);
+void client_hide(struct Client *c);
+void client_show(struct Client *c);
 
 // These signatures must match that of the callback in list_find
 bool client_has_win(void *client, void *window);
@@ -54,6 +87,8 @@ bool client_has_win(void *client, void *window);
 void client_urgent_set(struct Client *c, bool is_urgent);
 
 void client_name_update(Client *c);
+void client_name_set(Client *c, const char *name);
+void client_protocols_update(Client *c);
 void client_update_size_hints(Client *c);
 void client_update_wm_hints(Client *c);
 void client_update_window_type(Client *c);
@@ -67,11 +102,19 @@ bool client_equal(void *client_a, void *client_b)
 	return client_a == client_b;
 }
 
+// The monitor showing the client's tagview, NULL if that tagview is hidden.
+struct Monitor *client_mon_get(const struct Client *c);
+
 bool isvisible(const Client *c);
 int width(const Client *c);
 int height(const Client *c);
 void configure(Client *c);
+int applysizehints(Client *c, int *x, int *y, int *w, int *h, int interact);
 void resize(Client *c, int x, int y, int w, int h, int interact);
 void resizeclient(Client *c, int x, int y, int w, int h);
 
+// Same as resizeclient(), but does not wait for the X server to process the
+// request.
+void client_geom_configure(Client *c, int x, int y, int w, int h);
+
 #endif
@@ -0,0 +1,159 @@
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+
+#include "clientlist.h"
+
+#include "debug.h"
+#include "dwm.h"
+#include "util.h"
+
+//******************************************************************************
+// Module variables
+//******************************************************************************
+// Both arrays hold the same windows, in different orders.
+static Window *clients;  // In the order they were managed
+static Window *stacking; // Bottom to top
+static int size;
+static int capacity;
+static bool clients_changed;
+static bool stacking_changed;
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static void capacity_ensure(int new_size);
+static int index_find(const Window *wins, Window w);
+static void remove_at(Window *wins, int i);
+static void insert_at(Window *wins, int i, Window w);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+void clientlist_add(Window w)
+{
+	capacity_ensure(size + 1);
+	clients[size] = w;
+	stacking[size] = w;
+	size++;
+	clients_changed = stacking_changed = true;
+}
+
+void clientlist_rm(Window w)
+{
+	int i = index_find(clients, w);
+
+	if (i < 0) {
+		return;
+	}
+	remove_at(clients, i);
+	remove_at(stacking, index_find(stacking, w));
+	size--;
+	clients_changed = stacking_changed = true;
+}
+
+void clientlist_stack_below(Window w, Window sibling)
+{
+	int i = index_find(stacking, w);
+	int s;
+
+	if (i < 0 || w == sibling) {
+		return;
+	}
+	remove_at(stacking, i);
+	// Below the sibling means at its index, shifting it up.
+	s = index_find(stacking, sibling);
+	if (s < 0) {
+		s = size - 1;
+	}
+	insert_at(stacking, s, w);
+	stacking_changed = stacking_changed || s != i;
+}
+
+void clientlist_raise(Window w)
+{
+	int i = index_find(stacking, w);
+
+	if (i < 0 || i == size - 1) {
+		return;
+	}
+	remove_at(stacking, i);
+	insert_at(stacking, size - 1, w);
+	stacking_changed = true;
+}
+
+int clientlist_size_get(void)
+{
+	return size;
+}
+
+void clientlist_publish(void)
+{
+	if (clients_changed) {
+		XChangeProperty(dpy, root, netatom[NetClientList],
+				XA_WINDOW, 32, PropModeReplace,
+				(unsigned char *) clients, size);
+	}
+	if (stacking_changed) {
+		XChangeProperty(dpy, root, netatom[NetClientListStacking],
+				XA_WINDOW, 32, PropModeReplace,
+				(unsigned char *) stacking, size);
+	}
+	P_DEBUG("%s: %d windows, list %d, stacking %d\n",
+		__func__, size, clients_changed, stacking_changed);
+	clients_changed = stacking_changed = false;
+}
+
+void clientlist_clear(void)
+{
+	free(clients);
+	free(stacking);
+	clients = stacking = NULL;
+	size = capacity = 0;
+	clients_changed = stacking_changed = false;
+	XDeleteProperty(dpy, root, netatom[NetClientList]);
+	XDeleteProperty(dpy, root, netatom[NetClientListStacking]);
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static void capacity_ensure(int new_size)
+{
+	if (new_size <= capacity) {
+		return;
+	}
+
+	int new_capacity = MAX(new_size, MAX(2 * capacity, 16));
+	clients = realloc(clients, new_capacity * sizeof(Window));
+	stacking = realloc(stacking, new_capacity * sizeof(Window));
+	if (clients == NULL || stacking == NULL) {
+		die("realloc:");
+	}
+	capacity = new_capacity;
+}
+
+static int index_find(const Window *wins, Window w)
+{
+	for (int i = 0; i < size; i++) {
+		if (wins[i] == w) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// Both work on size, the number of windows before the removal or after the
+// insertion.
+static void remove_at(Window *wins, int i)
+{
+	memmove(&wins[i], &wins[i + 1], (size - i - 1) * sizeof(Window));
+}
+
+static void insert_at(Window *wins, int i, Window w)
+{
+	memmove(&wins[i + 1], &wins[i], (size - i - 1) * sizeof(Window));
+	wins[i] = w;
+}
@@ -0,0 +1,52 @@
+#ifndef CLIENTLIST_H
+#define CLIENTLIST_H
+
+#include <X11/X.h>
+
+// Mirror of the EWMH root window properties listing the managed windows:
+// _NET_CLIENT_LIST, in the order the windows were managed, and
+// _NET_CLIENT_LIST_STACKING, from bottom to top. Changes are only recorded
+// here, and clientlist_publish() writes each property with a single request,
+// only if it changed.
+
+//  ----------------------------------------------------------------------------
+/// \brief  Add a newly managed window, on top of the stacking order.
+//  ----------------------------------------------------------------------------
+void clientlist_add(Window w);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Remove a window that is no longer managed. Nothing happens if the
+/// window is not in the list.
+//  ----------------------------------------------------------------------------
+void clientlist_rm(Window w);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Record a change in stacking order, same as the Sibling and
+/// StackMode Below of XConfigureWindow().
+/// \param  w  Window restacked.
+/// \param  sibling  Window w is now directly below. If it is not a managed
+/// window, e.g. a bar window, w is placed on top of all managed windows, even
+/// those the server keeps above sibling: record such raises after, in the
+/// order the changes take effect.
+//  ----------------------------------------------------------------------------
+void clientlist_stack_below(Window w, Window sibling);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Record that a window was raised on top of all others.
+//  ----------------------------------------------------------------------------
+void clientlist_raise(Window w);
+
+int clientlist_size_get(void);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Write the properties that changed since the last call to the root
+/// window.
+//  ----------------------------------------------------------------------------
+void clientlist_publish(void);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Empty the lists, free the storage, and delete the properties.
+//  ----------------------------------------------------------------------------
+void clientlist_clear(void);
+
+#endif
@@ -153,4 +153,10 @@ const struct config config = {
 	.focus = {
 		.tagview_change_ignores_mouse_over = true,
 	},
+	.status = {
+		.fifo_path = NULL,
+	},
+	.ipc = {
+		.socket_path = NULL,
+	},
 };
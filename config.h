@@ -59,6 +59,16 @@ struct config {
 	struct cfg_focus {
 		bool tagview_change_ignores_mouse_over;
 	} focus;
+	struct cfg_status {
+		// FIFO to read status lines from, NULL to only use the
+		// root window name. See status_fifo.h.
+		const char *fifo_path;
+	} status;
+	struct cfg_ipc {
+		// Unix socket to accept commands on, NULL for none. See
+		// ipc.h.
+		const char *socket_path;
+	} ipc;
 };
 
 extern const struct config config;
@@ -1,9 +1,15 @@
 #ifndef DM_H
 #define DM_H
 
+#include <X11/Xutil.h>
+
 #include "client.h"
 
 void dm_focus(struct Client *c);
 int dm_gettextprop(Window w, Atom atom, char *text, unsigned int size);
 
+// Convert a text property to a string in the current locale. The property
+// value does not need to be null terminated.
+int dm_textprop_decode(const XTextProperty *prop, char *text, unsigned int size);
+
 #endif
@@ -1,7 +1,9 @@
+#include <string.h>
 #include <X11/Xatom.h>
 
 #include "dm.h"
 #include "dwm.h"
+#include "util.h"
 
 void dm_focus(struct Client *c)
 {
@@ -15,25 +17,42 @@ void dm_focus(struct Client *c)
 }
 
 int dm_gettextprop(Window w, Atom atom, char *text, unsigned int size)
+{
+	XTextProperty name;
+	int ret;
+
+	if (!text || size == 0)
+		return 0;
+	text[0] = '\0';
+	if (!XGetTextProperty(dpy, w, &name, atom))
+		return 0;
+	ret = dm_textprop_decode(&name, text, size);
+	XFree(name.value);
+	return ret;
+}
+
+int dm_textprop_decode(const XTextProperty *prop, char *text, unsigned int size)
 {
 	char **list = NULL;
 	int n;
-	XTextProperty name;
 
 	if (!text || size == 0)
 		return 0;
 	text[0] = '\0';
-	if (!XGetTextProperty(dpy, w, &name, atom) || !name.nitems)
+	if (!prop->value || !prop->nitems)
 		return 0;
-	if (name.encoding == XA_STRING) {
-		strncpy(text, (char *) name.value, size - 1);
+	if (prop->encoding == XA_STRING) {
+		n = MIN(prop->nitems, size - 1);
+		memcpy(text, prop->value, n);
+		text[n] = '\0';
 	} else {
-		if (XmbTextPropertyToTextList(dpy, &name, &list, &n) >= Success && n > 0 && *list) {
+		if (XmbTextPropertyToTextList(dpy, (XTextProperty *) prop, &list, &n) >= Success
+		    && n > 0 && *list) {
 			strncpy(text, *list, size - 1);
-			XFreeStringList(list);
 		}
+		if (list)
+			XFreeStringList(list);
 	}
 	text[size - 1] = '\0';
-	XFree(name.value);
 	return 1;
 }
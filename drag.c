@@ -0,0 +1,142 @@
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+#include <X11/Xlib.h>
+#ifdef XRANDR
+#include <X11/extensions/Xrandr.h>
+#endif /* XRANDR */
+
+#include "drag.h"
+
+#include "debug.h"
+#include "dwm.h"
+#include "input.h"
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+#define DRAG_MASK (MOUSEMASK | ExposureMask | SubstructureRedirectMask)
+#define REFRESH_RATE_DEFAULT 60.0 // Hz, without RandR or if it does not know
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static int64_t now_ns(void);
+static double refresh_rate_get(const struct Monitor *m);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+void drag_run(struct Monitor *m, drag_motion_t motion, void *data)
+{
+	const int64_t period = 1e9 / refresh_rate_get(m);
+	int64_t deadline = 0; // No update before, in now_ns() time
+	struct pollfd pfd = { .fd = ConnectionNumber(dpy), .events = POLLIN };
+	bool released = false;
+	bool moved = false; // Since the last update
+	int x = 0, y = 0;
+	XEvent ev;
+	P_INT(n_motions = 0);
+	P_INT(n_updates = 0);
+
+	while (true) {
+		// Take everything queued: only the latest motion matters.
+		while (!released && XCheckMaskEvent(dpy, DRAG_MASK, &ev)) {
+			switch (ev.type) {
+			case ConfigureRequest:
+			case Expose:
+			case MapRequest:
+				xeventhandler(&ev);
+				mon_flush_all(&mons);
+				break;
+			case MotionNotify:
+				x = ev.xmotion.x_root;
+				y = ev.xmotion.y_root;
+				moved = true;
+#if defined(DEBUG)
+				n_motions++;
+#endif
+				break;
+			case ButtonRelease:
+				released = true;
+				break;
+			}
+		}
+
+		int64_t now = now_ns();
+
+		// The last position is always applied, even early.
+		if (moved && (released || now >= deadline)) {
+			motion(x, y, data);
+			XFlush(dpy);
+			moved = false;
+			deadline = now + period;
+#if defined(DEBUG)
+			n_updates++;
+#endif
+		}
+		if (released) {
+			break;
+		}
+		// Wait for events, or for the end of the frame if a motion is
+		// pending. Events not in DRAG_MASK stay queued for run().
+		poll(&pfd, 1, moved ? (deadline - now + 999999) / 1000000 : -1);
+	}
+	P_DEBUG("%s: %d motions, %d updates, %.1f Hz\n",
+		__func__, n_motions, n_updates, 1e9 / period);
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static int64_t now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Refresh rate of the CRTC showing the top left corner of the monitor.
+static double refresh_rate_get(const struct Monitor *m)
+{
+	double rate = 0;
+#ifdef XRANDR
+	XRRScreenResources *res;
+	int event_base, error_base;
+
+	if (!XRRQueryExtension(dpy, &event_base, &error_base)
+	    || (res = XRRGetScreenResourcesCurrent(dpy, root)) == NULL) {
+		return REFRESH_RATE_DEFAULT;
+	}
+	for (int i = 0; i < res->ncrtc && rate == 0; i++) {
+		XRRCrtcInfo *crtc = XRRGetCrtcInfo(dpy, res, res->crtcs[i]);
+
+		if (crtc == NULL) {
+			continue;
+		}
+		if (crtc->mode != None
+		    && m->mx >= crtc->x && m->mx < crtc->x + (int) crtc->width
+		    && m->my >= crtc->y && m->my < crtc->y + (int) crtc->height) {
+			for (int j = 0; j < res->nmode; j++) {
+				const XRRModeInfo *mode = &res->modes[j];
+
+				if (mode->id != crtc->mode
+				    || mode->hTotal == 0 || mode->vTotal == 0) {
+					continue;
+				}
+				rate = (double) mode->dotClock
+				       / ((double) mode->hTotal * mode->vTotal);
+				if (mode->modeFlags & RR_DoubleScan)
+					rate /= 2;
+				if (mode->modeFlags & RR_Interlace)
+					rate *= 2;
+			}
+		}
+		XRRFreeCrtcInfo(crtc);
+	}
+	XRRFreeScreenResources(res);
+#endif /* XRANDR */
+	return rate > 0 ? rate : REFRESH_RATE_DEFAULT;
+}
@@ -0,0 +1,25 @@
+#ifndef DRAG_H
+#define DRAG_H
+
+#include "monitor.h"
+
+// Pointer drags, for movemouse() and resizemouse(). The motion events queued
+// since the last update are compressed to the latest, and updates are paced to
+// the refresh rate of the monitor, from RandR if built with it, 60 Hz
+// otherwise: moving faster would only configure windows nobody sees.
+
+//  ----------------------------------------------------------------------------
+/// \brief  Called with the latest pointer position, at most once per frame.
+/// It should configure the window without waiting for the server.
+/// \param  x, y  Pointer position, relative to the root window.
+//  ----------------------------------------------------------------------------
+typedef void (*drag_motion_t)(int x, int y, void *data);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Run a drag until the button is released. The pointer must already
+/// be grabbed. Requests redirected meanwhile are handled as usual.
+/// \param  m  Monitor the drag starts on, its refresh rate paces the updates.
+//  ----------------------------------------------------------------------------
+void drag_run(struct Monitor *m, drag_motion_t motion, void *data);
+
+#endif
@@ -72,6 +72,11 @@ drw_create(Display *dpy, int screen, Window root, unsigned int w, unsigned int h
 	drw->h = h;
 	drw->drawable = XCreatePixmap(dpy, root, w, h, DefaultDepth(dpy, screen));
 	drw->gc = XCreateGC(dpy, root, 0, NULL);
+	drw->xftdraw = XftDrawCreate(dpy, drw->drawable,
+	                             DefaultVisual(dpy, screen),
+	                             DefaultColormap(dpy, screen));
+	drw->glyphs = ecalloc(DRW_GLYPHCACHE_SIZE, sizeof(Gly));
+	drw->ranges = ecalloc(DRW_RANGES_MAX, sizeof(Rng));
 	XSetLineAttributes(dpy, drw->gc, 1, LineSolid, CapButt, JoinMiter);
 
 	return drw;
@@ -88,14 +93,18 @@ drw_resize(Drw *drw, unsigned int w, unsigned int h)
 	if (drw->drawable)
 		XFreePixmap(drw->dpy, drw->drawable);
 	drw->drawable = XCreatePixmap(drw->dpy, drw->root, w, h, DefaultDepth(drw->dpy, drw->screen));
+	XftDrawChange(drw->xftdraw, drw->drawable);
 }
 
 void
 drw_free(Drw *drw)
 {
+	XftDrawDestroy(drw->xftdraw);
 	XFreePixmap(drw->dpy, drw->drawable);
 	XFreeGC(drw->dpy, drw->gc);
 	drw_fontset_free(drw->fonts);
+	free(drw->glyphs);
+	free(drw->ranges);
 	free(drw);
 }
 
@@ -166,6 +175,13 @@ xfont_free(Fnt *font)
 	free(font);
 }
 
+static void
+cacheclear(Drw *drw)
+{
+	memset(drw->glyphs, 0, DRW_GLYPHCACHE_SIZE * sizeof(Gly));
+	drw->nranges = 0;
+}
+
 Fnt*
 drw_fontset_create(Drw* drw, const char *fonts[], size_t fontcount)
 {
@@ -181,7 +197,8 @@ drw_fontset_create(Drw* drw, const char *fonts[], size_t fontcount)
 			ret = cur;
 		}
 	}
-	return (drw->fonts = ret);
+	drw_setfontset(drw, ret);
+	return ret;
 }
 
 void
@@ -225,8 +242,14 @@ drw_scm_create(Drw *drw, const char *clrnames[], size_t clrcount)
 void
 drw_setfontset(Drw *drw, Fnt *set)
 {
-	if (drw)
-		drw->fonts = set;
+	if (!drw)
+		return;
+	drw->fonts = set;
+	/* glyphs resolve to other fonts now */
+	cacheclear(drw);
+	drw->nfallbacks = 0;
+	for (; set; set = set->next)
+		drw->nfallbacks += set->isfallback;
 }
 
 void
@@ -248,23 +271,189 @@ drw_rect(Drw *drw, int x, int y, unsigned int w, unsigned int h, int filled, int
 		XDrawRectangle(drw->dpy, drw->drawable, drw->gc, x, y, w - 1, h - 1);
 }
 
+/* Index of the first range starting after codepoint */
+static size_t
+rangeindex(Drw *drw, long codepoint)
+{
+	size_t lo = 0, hi = drw->nranges, mid;
+
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (drw->ranges[mid].lo <= codepoint)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static Rng *
+rangefind(Drw *drw, long codepoint)
+{
+	size_t i = rangeindex(drw, codepoint);
+
+	if (i && drw->ranges[i - 1].hi >= codepoint)
+		return &drw->ranges[i - 1];
+	return NULL;
+}
+
+/* Record the font of a codepoint that is in no range yet, extending or
+ * merging the neighbouring ranges of the same font. */
+static void
+rangeadd(Drw *drw, long codepoint, Fnt *font)
+{
+	size_t i = rangeindex(drw, codepoint);
+	Rng *prev = i ? &drw->ranges[i - 1] : NULL;
+	Rng *next = i < drw->nranges ? &drw->ranges[i] : NULL;
+
+	if (prev && prev->font == font && prev->hi + 1 == codepoint) {
+		prev->hi = codepoint;
+		if (next && next->font == font && next->lo == codepoint + 1) {
+			prev->hi = next->hi;
+			memmove(next, next + 1, (drw->nranges - i - 1) * sizeof(Rng));
+			drw->nranges--;
+		}
+		return;
+	}
+	if (next && next->font == font && next->lo == codepoint + 1) {
+		next->lo = codepoint;
+		return;
+	}
+	if (drw->nranges == DRW_RANGES_MAX) {
+		drw->nranges = i = 0;
+	}
+	memmove(&drw->ranges[i + 1], &drw->ranges[i], (drw->nranges - i) * sizeof(Rng));
+	drw->ranges[i] = (Rng){ .lo = codepoint, .hi = codepoint, .font = font };
+	drw->nranges++;
+}
+
+/* Close the least recently used fallback fonts not used by the current
+ * drw_text call, until a new one may be loaded. The caches refer to the closed
+ * fonts, they are emptied. */
+static void
+fallbackevict(Drw *drw)
+{
+	Fnt **f, **lru, *evicted;
+
+	while (drw->nfallbacks >= DRW_FALLBACKS_MAX) {
+		lru = NULL;
+		for (f = &drw->fonts; *f; f = &(*f)->next)
+			if ((*f)->isfallback && (*f)->lastused != drw->tick
+			    && (!lru || (*f)->lastused < (*lru)->lastused))
+				lru = f;
+		if (!lru)
+			return;
+
+		evicted = *lru;
+		*lru = evicted->next;
+		xfont_free(evicted);
+		drw->nfallbacks--;
+		drw->stats.evictions++;
+		cacheclear(drw);
+	}
+}
+
+/* Find the font drawing a codepoint: the first one of the set having it, or
+ * else a fallback font matching the first one, which is appended to the set.
+ * Returns NULL if there is none. */
+static Fnt *
+xfont_resolve(Drw *drw, long codepoint)
+{
+	Fnt *curfont, *fallback;
+	FcCharSet *fccharset;
+	FcPattern *fcpattern;
+	FcPattern *match;
+	XftResult result;
+
+	for (curfont = drw->fonts; curfont; curfont = curfont->next)
+		if (XftCharExists(drw->dpy, curfont->xfont, codepoint))
+			return curfont;
+
+	fccharset = FcCharSetCreate();
+	FcCharSetAddChar(fccharset, codepoint);
+
+	if (!drw->fonts->pattern) {
+		/* Refer to the comment in xfont_create for more information. */
+		die("the first font in the cache must be loaded from a font string.");
+	}
+
+	fcpattern = FcPatternDuplicate(drw->fonts->pattern);
+	FcPatternAddCharSet(fcpattern, FC_CHARSET, fccharset);
+	FcPatternAddBool(fcpattern, FC_SCALABLE, FcTrue);
+	FcPatternAddBool(fcpattern, FC_COLOR, FcFalse);
+
+	FcConfigSubstitute(NULL, fcpattern, FcMatchPattern);
+	FcDefaultSubstitute(fcpattern);
+	match = XftFontMatch(drw->dpy, drw->screen, fcpattern, &result);
+
+	FcCharSetDestroy(fccharset);
+	FcPatternDestroy(fcpattern);
+
+	if (match) {
+		fallback = xfont_create(drw, NULL, match);
+		if (fallback && XftCharExists(drw->dpy, fallback->xfont, codepoint)) {
+			fallbackevict(drw);
+			for (curfont = drw->fonts; curfont->next; curfont = curfont->next)
+				; /* NOP */
+			curfont->next = fallback;
+			fallback->isfallback = 1;
+			drw->nfallbacks++;
+			drw->stats.fallbacks++;
+			return fallback;
+		}
+		xfont_free(fallback);
+	}
+	return NULL;
+}
+
+/* Font and advance width of a codepoint. The fonts are only asked if the
+ * codepoint is in neither the glyph cache nor the range cache. Codepoints no
+ * font covers are drawn with the missing glyph of the first font. */
+static const Gly *
+getglyph(Drw *drw, long codepoint)
+{
+	Gly *g = &drw->glyphs[codepoint & (DRW_GLYPHCACHE_SIZE - 1)];
+	FcChar32 c = codepoint;
+	XGlyphInfo ext;
+	Rng *r;
+	Fnt *font;
+
+	if (g->font && g->codepoint == codepoint) {
+		drw->stats.hits++;
+		g->font->lastused = drw->tick;
+		return g;
+	}
+
+	if ((r = rangefind(drw, codepoint))) {
+		drw->stats.rangehits++;
+		drw->stats.nofont += !r->font;
+		font = r->font;
+	} else {
+		drw->stats.misses++;
+		font = xfont_resolve(drw, codepoint);
+		rangeadd(drw, codepoint, font);
+	}
+
+	g->font = font ? font : drw->fonts;
+	g->codepoint = codepoint;
+	g->font->lastused = drw->tick;
+	XftTextExtents32(drw->dpy, g->font->xfont, &c, 1, &ext);
+	g->w = ext.xOff;
+	return g;
+}
+
 int
 drw_text(Drw *drw, int x, int y, unsigned int w, unsigned int h, unsigned int lpad, const char *text, int invert)
 {
 	char buf[1024];
 	int ty;
-	unsigned int ew;
-	XftDraw *d = NULL;
-	Fnt *usedfont, *curfont, *nextfont;
-	size_t i, len;
-	int utf8strlen, utf8charlen, render = x || y || w || h;
+	unsigned int ew, runw;
+	Fnt *usedfont;
+	const Gly *g;
+	size_t i, len, runlen;
+	int utf8charlen, render = x || y || w || h;
 	long utf8codepoint = 0;
 	const char *utf8str;
-	FcCharSet *fccharset;
-	FcPattern *fcpattern;
-	FcPattern *match;
-	XftResult result;
-	int charexists = 0;
 
 	if (!drw || (render && !drw->scheme) || !text || !drw->fonts)
 		return 0;
@@ -274,107 +463,51 @@ drw_text(Drw *drw, int x, int y, unsigned int w, unsigned int h, unsigned int lp
 	} else {
 		XSetForeground(drw->dpy, drw->gc, drw->scheme[invert ? ColFg : ColBg].pixel);
 		XFillRectangle(drw->dpy, drw->drawable, drw->gc, x, y, w, h);
-		d = XftDrawCreate(drw->dpy, drw->drawable,
-		                  DefaultVisual(drw->dpy, drw->screen),
-		                  DefaultColormap(drw->dpy, drw->screen));
 		x += lpad;
 		w -= lpad;
 	}
 
-	usedfont = drw->fonts;
-	while (1) {
-		utf8strlen = 0;
+	drw->tick++;
+	while (*text) {
+		/* Take the run of characters drawn with the same font. Summing
+		 * the cached advances gives the width of each prefix, so the
+		 * longest prefix fitting in w is found in the same pass. */
 		utf8str = text;
-		nextfont = NULL;
+		usedfont = NULL;
+		len = runlen = 0;
+		ew = runw = 0;
 		while (*text) {
 			utf8charlen = utf8decode(text, &utf8codepoint, UTF_SIZ);
-			for (curfont = drw->fonts; curfont; curfont = curfont->next) {
-				charexists = charexists || XftCharExists(drw->dpy, curfont->xfont, utf8codepoint);
-				if (charexists) {
-					if (curfont == usedfont) {
-						utf8strlen += utf8charlen;
-						text += utf8charlen;
-					} else {
-						nextfont = curfont;
-					}
-					break;
-				}
-			}
-
-			if (!charexists || nextfont)
+			g = getglyph(drw, utf8codepoint);
+			if (usedfont && g->font != usedfont)
 				break;
-			else
-				charexists = 0;
-		}
-
-		if (utf8strlen) {
-			drw_font_getexts(usedfont, utf8str, utf8strlen, &ew, NULL);
-			/* shorten text if necessary */
-			for (len = MIN(utf8strlen, sizeof(buf) - 1); len && ew > w; len--)
-				drw_font_getexts(usedfont, utf8str, len, &ew, NULL);
-
-			if (len) {
-				memcpy(buf, utf8str, len);
-				buf[len] = '\0';
-				if (len < utf8strlen)
-					for (i = len; i && i > len - 3; buf[--i] = '.')
-						; /* NOP */
-
-				if (render) {
-					ty = y + (h - usedfont->h) / 2 + usedfont->xfont->ascent;
-					XftDrawStringUtf8(d, &drw->scheme[invert ? ColBg : ColFg],
-					                  usedfont->xfont, x, ty, (XftChar8 *)buf, len);
-				}
-				x += ew;
-				w -= ew;
+			usedfont = g->font;
+			runw += g->w;
+			runlen += utf8charlen;
+			text += utf8charlen;
+			if (runw <= w && runlen < sizeof(buf)) {
+				len = runlen;
+				ew = runw;
 			}
 		}
 
-		if (!*text) {
-			break;
-		} else if (nextfont) {
-			charexists = 0;
-			usedfont = nextfont;
-		} else {
-			/* Regardless of whether or not a fallback font is found, the
-			 * character must be drawn. */
-			charexists = 1;
-
-			fccharset = FcCharSetCreate();
-			FcCharSetAddChar(fccharset, utf8codepoint);
-
-			if (!drw->fonts->pattern) {
-				/* Refer to the comment in xfont_create for more information. */
-				die("the first font in the cache must be loaded from a font string.");
-			}
-
-			fcpattern = FcPatternDuplicate(drw->fonts->pattern);
-			FcPatternAddCharSet(fcpattern, FC_CHARSET, fccharset);
-			FcPatternAddBool(fcpattern, FC_SCALABLE, FcTrue);
-			FcPatternAddBool(fcpattern, FC_COLOR, FcFalse);
-
-			FcConfigSubstitute(NULL, fcpattern, FcMatchPattern);
-			FcDefaultSubstitute(fcpattern);
-			match = XftFontMatch(drw->dpy, drw->screen, fcpattern, &result);
-
-			FcCharSetDestroy(fccharset);
-			FcPatternDestroy(fcpattern);
-
-			if (match) {
-				usedfont = xfont_create(drw, NULL, match);
-				if (usedfont && XftCharExists(drw->dpy, usedfont->xfont, utf8codepoint)) {
-					for (curfont = drw->fonts; curfont->next; curfont = curfont->next)
-						; /* NOP */
-					curfont->next = usedfont;
-				} else {
-					xfont_free(usedfont);
-					usedfont = drw->fonts;
-				}
+		if (len) {
+			memcpy(buf, utf8str, len);
+			buf[len] = '\0';
+			/* shorten text if necessary */
+			if (len < runlen)
+				for (i = len; i && i > len - 3; buf[--i] = '.')
+					; /* NOP */
+
+			if (render) {
+				ty = y + (h - usedfont->h) / 2 + usedfont->xfont->ascent;
+				XftDrawStringUtf8(drw->xftdraw, &drw->scheme[invert ? ColBg : ColFg],
+				                  usedfont->xfont, x, ty, (XftChar8 *)buf, len);
 			}
+			x += ew;
+			w -= ew;
 		}
 	}
-	if (d)
-		XftDrawDestroy(d);
 
 	return x + (render ? w : 0);
 }
@@ -385,8 +518,9 @@ drw_map(Drw *drw, Window win, int x, int y, unsigned int w, unsigned int h)
 	if (!drw)
 		return;
 
+	/* Everything is drawn to the pixmap first, a frame reaches the window
+	 * with this single copy. No sync, the event loop flushes it. */
 	XCopyArea(drw->dpy, drw->drawable, win, drw->gc, x, y, w, h, x, y);
-	XSync(drw->dpy, False);
 }
 
 unsigned int
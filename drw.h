@@ -14,9 +14,37 @@ typedef struct Fnt {
 	unsigned int h;
 	XftFont      *xfont;
 	FcPattern    *pattern;
+	int          isfallback; /* loaded by drw_text, may be evicted */
+	unsigned long lastused;  /* Drw tick when it last drew a glyph */
 	struct Fnt   *next;
 } Fnt;
 
+/* Font and advance width of a codepoint, as resolved through the font set */
+#define DRW_GLYPHCACHE_SIZE 1024 /* must be a power of two */
+typedef struct {
+	long         codepoint;
+	Fnt          *font; /* NULL if the entry is empty */
+	unsigned int w;
+} Gly;
+
+/* Codepoints lo to hi all resolve to the same font, NULL if none covers them */
+typedef struct {
+	long         lo, hi;
+	Fnt          *font;
+} Rng;
+
+#define DRW_RANGES_MAX    4096 /* the range cache is emptied when full */
+#define DRW_FALLBACKS_MAX 8    /* fallback fonts kept open, least recently used closed first */
+
+typedef struct {
+	unsigned long hits;      /* codepoints found in the glyph cache */
+	unsigned long rangehits; /* resolved by the range cache */
+	unsigned long nofont;    /* ... of which no font covers */
+	unsigned long misses;    /* resolved by asking the fonts and fontconfig */
+	unsigned long fallbacks; /* fallback fonts loaded */
+	unsigned long evictions; /* fallback fonts closed */
+} Fntstats;
+
 enum { ColFg, ColBg, ColBorder }; /* Clr scheme index */
 typedef XftColor Clr;
 
@@ -27,8 +55,15 @@ typedef struct {
 	Window       root;
 	Drawable     drawable;
 	GC           gc;
+	XftDraw      *xftdraw; /* bound to drawable */
 	Clr          *scheme;
 	Fnt          *fonts;
+	Gly          *glyphs; /* direct-mapped cache, DRW_GLYPHCACHE_SIZE entries */
+	Rng          *ranges; /* sorted, DRW_RANGES_MAX entries */
+	size_t       nranges;
+	unsigned int nfallbacks;
+	unsigned long tick;   /* incremented by every drw_text call */
+	Fntstats     stats;
 } Drw;
 
 /* Drawable abstraction */
@@ -23,15 +23,14 @@
 #include <assert.h>
 #include <errno.h>
 #include <locale.h>
-#include <signal.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/types.h>
-#include <sys/wait.h>
 #include <X11/cursorfont.h>
 #include <X11/keysym.h>
 #include <X11/Xatom.h>
@@ -47,13 +46,21 @@
 
 #include "bar.h"
 #include "client.h"
+#include "clientlist.h"
 #include "debug.h"
 #include "dm.h"
 #include "drw.h"
+#include "evbatch.h"
+#include "evloop.h"
+#include "ipc.h"
+#include "proc.h"
 #include "linkedlist/linkedlist.h"
 #include "monitor.h"
+#include "prefetch.h"
+#include "status_fifo.h"
 #include "tagview.h"
 #include "util.h"
+#include "winindex/winindex.h"
 
 /* macros */
 #define CLEANMASK(mask)                                                 \
@@ -68,6 +75,7 @@
 /* enums */
 
 /* function declarations */
+static void batch_end(void);
 static void buttonpress(const XEvent *e);
 static void checkotherwm(void);
 static void cleanup(void);
@@ -77,10 +85,10 @@ static void configurenotify(const XEvent *e);
 static void configurerequest(const XEvent *e);
 static void destroynotify(const XEvent *e);
 static void detach(Client *c);
+static double elapsed_ms(const struct timespec *start, const struct timespec *end);
 static void enternotify(const XEvent *e);
 static void expose(const XEvent *e);
 static void focusin(const XEvent *e);
-static long getstate(Window w);
 static void grabkeys(void);
 static void keypress(const XEvent *e);
 static void mappingnotify(const XEvent *e);
@@ -90,11 +98,10 @@ static void propertynotify(const XEvent *e);
 static void run(void);
 static void scan(void);
 static void setup(void);
-static void sigchld(int unused);
+static void status_fifo_readable(int fd, void *data);
 static void unmanage(Client *c, int destroyed);
 static void unmapnotify(const XEvent *e);
 static void updatebars(void);
-static void updateclientlist(void);
 static int updategeom(void);
 
 
@@ -136,9 +143,15 @@ int screen_w, screen_h; // X display screen geometry width, height. Of the
                         // default screen only??
 int bar_h, bar_w = 0;   /* bar geometry */
 unsigned int numlockmask = 0;
+static bool numlockmask_valid = false;
+static KeyCode numlock_keycode;
 
 bool skip_mouse_over_focus_once = false;
 
+// Set by the event handlers to sync once at the end of the event batch, see
+// run(). Arranging and drawing are deferred with the monitor dirty bits.
+static bool batch_sync = false;
+
 /* configuration, allows nested code to access above variables */
 #include "config.h"
 
@@ -216,6 +229,13 @@ cleanup(void)
 	// TODO: free the monitors, clients, layouts, tagviews, ...
 	XUngrabKey(dpy, AnyKey, AnyModifier, root);
 	list_run_for_all(&mons, cleanupmon, NULL);
+	winindex_clear();
+	evbatch_clear();
+	clientlist_clear();
+	ipc_close();
+	proc_clear();
+	evloop_clear();
+	status_fifo_close();
 
 	for (i = 0; i < CurLast; i++)
 		drw_cur_free(drw, cursor[i]);
@@ -300,7 +320,7 @@ configurenotify(const XEvent *e)
 				}
 #endif
 			client_focus(NULL);
-			mon_arrange(NULL);
+			list_run_for_all(&mons, mon_arrange_schedule_cb, NULL);
 		}
 	}
 }
@@ -355,7 +375,7 @@ configurerequest(const XEvent *e)
 		wc.stack_mode = ev->detail;
 		XConfigureWindow(dpy, ev->window, ev->value_mask, &wc);
 	}
-	XSync(dpy, False);
+	batch_sync = true;
 }
 
 void
@@ -372,26 +392,42 @@ destroynotify(const XEvent *e)
 void detach(Client *c)
 {
 	P_DEBUG("%s(%p)\n", __func__, (void *) c);
-	struct Monitor *m = wintomon(c->win);
-	struct Client *new_selected_c = mon_selected_client_get(m);
+	// The tagview holding the client, shown or not: the list of another
+	// one must not be touched, the client link is only valid in its own.
+	struct tagview *tv = c->tagview;
+
+	if (tv == NULL) {
+		return;
+	}
+
+	struct Client *new_selected_c = tagview_selected_client_get(tv);
 	if (c == new_selected_c) {
-		new_selected_c = list_next_select(&m->tagview->clients);
+		new_selected_c = list_next_select(&tv->clients);
 	}
 	if (c == new_selected_c) {
-		new_selected_c = list_prev_select(&m->tagview->clients);
+		new_selected_c = list_prev_select(&tv->clients);
 	}
 	if (c == new_selected_c) {
 		new_selected_c = NULL;
 	}
 
-	list_rm(&m->tagview->clients, c);
+	list_rm(&tv->clients, c);
+	c->tagview = NULL;
+	winindex_rm(c->win);
 
 	if (new_selected_c == NULL) {
 		// The list head might be NULL
-		list_head_select(&m->tagview->clients);
+		list_head_select(&tv->clients);
 	}
 }
 
+double
+elapsed_ms(const struct timespec *start, const struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e3
+	       + (end->tv_nsec - start->tv_nsec) / 1e6;
+}
+
 void
 dwm_quit(void)
 {
@@ -414,7 +450,7 @@ enternotify(const XEvent *e)
 		return;
 	c = wintoclient(ev->window);
 
-	m = list_find(&mons, mon_has_client, c);
+	m = c ? client_mon_get(c) : NULL;
 	struct Client *sel_client = mon_selected_client_get(selmon);
 
 	if (m != NULL && m != selmon) {
@@ -432,8 +468,10 @@ expose(const XEvent *e)
 #if BAR
 	Monitor *m;
 	const XExposeEvent *ev = &e->xexpose;
-	if (ev->count == 0 && (m = wintomon(ev->window)))
-		bar_draw(m);
+	if (ev->count == 0 && (m = wintomon(ev->window))) {
+		bar_damage(m);
+		mon_bar_schedule(m);
+	}
 #endif
 }
 
@@ -459,43 +497,32 @@ getrootptr(int *x, int *y)
 	return XQueryPointer(dpy, root, &dummy, &dummy, x, y, &di, &di, &dui);
 }
 
-long
-getstate(Window w)
-{
-	int format;
-	long result = -1;
-	unsigned char *p = NULL;
-	unsigned long n, extra;
-	Atom real;
-
-	if (XGetWindowProperty(dpy, w, wmatom[WMState], 0L, 2L, False, wmatom[WMState],
-			       &real, &format, &n, &extra, (unsigned char **) &p) != Success)
-		return -1;
-	if (n != 0)
-		result = *p;
-	XFree(p);
-	return result;
-}
-
-
 void updatenumlockmask(void)
 {
 	unsigned int i, j;
 	XModifierKeymap *modmap;
 
 	/// I don't understand this. Why would NumLock need such a
-	/// special handling? Why does it need updating this often?
+	/// special handling?
+	// The mask only changes with the keyboard mapping, it is
+	// invalidated by mappingnotify().
+	if (numlockmask_valid)
+		return;
+
 	numlockmask = 0;
+	numlock_keycode = XKeysymToKeycode(dpy, XK_Num_Lock);
 	modmap = XGetModifierMapping(dpy);
 	// There are 8 modifiers in X
 	for (i = 0; i < 8; i++)
 		// Multiple keys can trigger the same modifier,
 		// e.g. you may have two Shift keys.
 		for (j = 0; j < modmap->max_keypermod; j++)
-			if (modmap->modifiermap[i * modmap->max_keypermod + j]
-			    == XKeysymToKeycode(dpy, XK_Num_Lock))
+			if (numlock_keycode != 0
+			    && modmap->modifiermap[i * modmap->max_keypermod + j]
+			    == numlock_keycode)
 				numlockmask = (1 << i);
 	XFreeModifiermap(modmap);
+	numlockmask_valid = true;
 }
 
 void
@@ -551,8 +578,11 @@ mappingnotify(const XEvent *e)
 	XMappingEvent ev = e->xmapping;
 
 	XRefreshKeyboardMapping(&ev);
-	if (ev.request == MappingKeyboard)
+	if (ev.request == MappingModifier || ev.request == MappingKeyboard) {
+		/* NumLock may have moved to another key or modifier */
+		numlockmask_valid = false;
 		grabkeys();
+	}
 }
 
 void
@@ -610,8 +640,7 @@ propertynotify(const XEvent *e)
 			    && XGetTransientForHint(dpy, c->win, &trans)
 			    && (c->isfloating = (wintoclient(trans) != NULL))
 			    ) {
-				// This could run only on the relevant monitor:
-				list_run_for_all(&mons, mon_arrange_cb, NULL);
+				mon_arrange_schedule(client_mon_get(c));
 			}
 			break;
 		case XA_WM_NORMAL_HINTS:
@@ -619,18 +648,21 @@ propertynotify(const XEvent *e)
 			break;
 		case XA_WM_HINTS:
 			client_update_wm_hints(c);
-			bar_draw_all_mons(&mons);
+			list_run_for_all(&mons, mon_bar_schedule_cb, NULL);
 			break;
 		}
 		if (ev->atom == XA_WM_NAME || ev->atom == netatom[NetWMName]) {
 			client_name_update(c);
+			ipc_event(IPC_EVENT_TITLE, c->win);
 #if BAR
-			if (c == mon_selected_client_get(c->mon))
-				bar_draw(c->mon);
+			if (c == mon_selected_client_get(client_mon_get(c)))
+				mon_bar_schedule(client_mon_get(c));
 #endif
 		}
 		if (ev->atom == netatom[NetWMWindowType])
 			client_update_window_type(c);
+		if (ev->atom == wmatom[WMProtocols])
+			client_protocols_update(c);
 	}
 }
 
@@ -659,40 +691,130 @@ run(void)
 
 	P_DEBUG("run start\n"); fflush(stdout);
 	/* main event loop */
+	mon_flush_all(&mons); // Work scheduled by scan()
+	clientlist_publish();
 	XSync(dpy, False);
-	while (running && !XNextEvent(dpy, &ev)) {
-		if (handler[ev.type])
-			handler[ev.type](&ev); /* call handler */
+	while (running) {
+		// XPending() flushes the requests and reads what the server
+		// sent, without blocking.
+		if (!XPending(dpy)) {
+			// The other inputs are handled by their callbacks,
+			// their deferred work is done like after X events.
+			if (!evloop_wait(ConnectionNumber(dpy)))
+				batch_end();
+			continue;
+		}
+		XNextEvent(dpy, &ev);
+		// Handle everything already received at once, with redundant
+		// events coalesced, then do the deferred work once.
+		evbatch_collect(dpy, &ev);
+		while (running && evbatch_next(&ev)) {
+			if (handler[ev.type])
+				handler[ev.type](&ev); /* call handler */
+		}
+		batch_end();
 	}
 }
 
+
+void
+status_fifo_readable(int fd, void *data)
+{
+	if (!status_fifo_read())
+		evloop_fd_rm(fd);
+}
+
+void
+batch_end(void)
+{
+	// Each monitor is arranged and restacked at most once per batch.
+	mon_flush_all(&mons);
+	clientlist_publish();
+	ipc_events_publish();
+	if (batch_sync)
+		XSync(dpy, False);
+	batch_sync = false;
+
+	P_DEBUG("%s: %lu events received, %lu dispatched, %lu PropertyNotify "
+		"and %lu ConfigureRequest coalesced\n",
+		__func__,
+		evbatch_stats_get()->received,
+		evbatch_stats_get()->dispatched,
+		evbatch_stats_get()->coalesced_property,
+		evbatch_stats_get()->coalesced_configure);
+}
+
 void
 scan(void)
 {
-	unsigned int i, num;
+	unsigned int i, num, n_managed = 0;
 	Window d1, d2, *wins = NULL;
-	XWindowAttributes wa;
-
-	/// TODO: should this be protected by XGrabServer()?
-	if (XQueryTree(dpy, root, &d1, &d2, &wins, &num)) {
-		for (i = 0; i < num; i++) {
-			if (!XGetWindowAttributes(dpy, wins[i], &wa)
-			    || wa.override_redirect || XGetTransientForHint(dpy, wins[i], &d1))
-				continue;
-			if (wa.map_state == IsViewable || getstate(wins[i]) == IconicState)
-				client_create(wins[i], &wa);
-		}
-		for (i = 0; i < num; i++) { /* now the transients */
-			if (!XGetWindowAttributes(dpy, wins[i], &wa))
-				continue;
-			if (XGetTransientForHint(dpy, wins[i], &d1)
-			    && (wa.map_state == IsViewable || getstate(wins[i]) == IconicState))
-				client_create(wins[i], &wa);
-		}
-		if (wins)
-			XFree(wins);
+	struct prefetch_state *states;
+	struct window_state *ws;
+	struct prefetch *props_requests;
+	struct client_props *props;
+	bool *manage;
+	struct timespec t_start, t_props, t_manage, t_end;
+
+	clock_gettime(CLOCK_MONOTONIC, &t_start);
+	XGrabServer(dpy); /* windows must not change between query and manage */
+	if (!XQueryTree(dpy, root, &d1, &d2, &wins, &num)) {
+		XUngrabServer(dpy);
+		return;
+	}
+
+	/* send the requests for all windows before waiting for any reply */
+	states = ecalloc(num, sizeof(*states));
+	ws = ecalloc(num, sizeof(*ws));
+	manage = ecalloc(num, sizeof(*manage));
+	props_requests = ecalloc(num, sizeof(*props_requests));
+	props = ecalloc(num, sizeof(*props));
+	for (i = 0; i < num; i++)
+		prefetch_state_send(&states[i], wins[i]);
+	for (i = 0; i < num; i++) {
+		manage[i] = prefetch_state_collect(&states[i], &ws[i])
+			    && !ws[i].wa.override_redirect
+			    && (ws[i].wa.map_state == IsViewable
+				|| ws[i].wm_state == IconicState);
+		if (manage[i])
+			n_managed++;
 	}
-	/// TODO: should this be unprotected by XUngrabServer()?
+
+	/* same for the properties of the windows to manage */
+	clock_gettime(CLOCK_MONOTONIC, &t_props);
+	for (i = 0; i < num; i++)
+		if (manage[i])
+			prefetch_send(&props_requests[i], wins[i]);
+	for (i = 0; i < num; i++)
+		if (manage[i])
+			prefetch_collect(&props_requests[i], &props[i]);
+
+	clock_gettime(CLOCK_MONOTONIC, &t_manage);
+	for (i = 0; i < num; i++)
+		if (manage[i] && !ws[i].is_transient)
+			client_create_with_props(wins[i], &ws[i].wa, &props[i]);
+	for (i = 0; i < num; i++) /* now the transients */
+		if (manage[i] && ws[i].is_transient)
+			client_create_with_props(wins[i], &ws[i].wa, &props[i]);
+	XUngrabServer(dpy);
+	clock_gettime(CLOCK_MONOTONIC, &t_end);
+
+	fprintf(stderr,
+		"dwm: scan: %u windows, %u managed in %.1f ms "
+		"(state %.1f ms, properties %.1f ms, manage %.1f ms)\n",
+		num, n_managed,
+		elapsed_ms(&t_start, &t_end),
+		elapsed_ms(&t_start, &t_props),
+		elapsed_ms(&t_props, &t_manage),
+		elapsed_ms(&t_manage, &t_end));
+
+	free(props);
+	free(props_requests);
+	free(manage);
+	free(ws);
+	free(states);
+	if (wins)
+		XFree(wins);
 }
 
 void
@@ -716,16 +838,12 @@ sendmon(Client *c, Monitor *m)
 int
 sendevent(Client *c, Atom proto)
 {
-	int n;
-	Atom *protocols;
 	int exists = 0;
 	XEvent ev;
 
-	if (XGetWMProtocols(dpy, c->win, &protocols, &n)) {
-		while (!exists && n--)
-			exists = protocols[n] == proto;
-		XFree(protocols);
-	}
+	for (int i = 0; i < WMLast; i++)
+		if (wmatom[i] == proto)
+			exists = (c->protocols >> i) & 1;
 	if (exists) {
 		ev.type = ClientMessage;
 		ev.xclient.window = c->win;
@@ -748,7 +866,7 @@ setup(void)
 	P_DEBUG("%s\n", __func__); fflush(stdout);
 
 	/* clean up any zombies immediately */
-	sigchld(0);
+	proc_init();
 
 	/* init screen */
 	screen = DefaultScreen(dpy);
@@ -775,6 +893,8 @@ setup(void)
 	netatom[NetWMWindowType] = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE", False);
 	netatom[NetWMWindowTypeDialog] = XInternAtom(dpy, "_NET_WM_WINDOW_TYPE_DIALOG", False);
 	netatom[NetClientList] = XInternAtom(dpy, "_NET_CLIENT_LIST", False);
+	netatom[NetClientListStacking] = XInternAtom(dpy, "_NET_CLIENT_LIST_STACKING", False);
+	netatom[NetWMPid] = XInternAtom(dpy, "_NET_WM_PID", False);
 	/* init cursors */
 	cursor[CurNormal] = drw_cur_create(drw, XC_left_ptr);
 	cursor[CurResize] = drw_cur_create(drw, XC_sizing);
@@ -787,6 +907,11 @@ setup(void)
 	/* init bars */
 	updatebars();
 	bar_status_update();
+	if (config.status.fifo_path != NULL
+	    && status_fifo_open(config.status.fifo_path) >= 0)
+		evloop_fd_add(status_fifo_fd_get(), status_fifo_readable, NULL);
+	if (config.ipc.socket_path != NULL)
+		ipc_open(config.ipc.socket_path);
 	/* supporting window for NetWMCheck */
 	wmcheckwin = XCreateSimpleWindow(dpy, root, 0, 0, 1, 1, 0, 0, 0);
 	XChangeProperty(dpy, wmcheckwin, netatom[NetWMCheck], XA_WINDOW, 32,
@@ -799,6 +924,7 @@ setup(void)
 	XChangeProperty(dpy, root, netatom[NetSupported], XA_ATOM, 32,
 			PropModeReplace, (unsigned char *) netatom, NetLast);
 	XDeleteProperty(dpy, root, netatom[NetClientList]);
+	XDeleteProperty(dpy, root, netatom[NetClientListStacking]);
 	/* select events */
 	wa.cursor = cursor[CurNormal]->cursor;
 	wa.event_mask = SubstructureRedirectMask | SubstructureNotifyMask
@@ -813,14 +939,6 @@ setup(void)
 }
 
 
-void
-sigchld(int unused)
-{
-	if (signal(SIGCHLD, sigchld) == SIG_ERR)
-		die("can't install SIGCHLD handler:");
-	while (0 < waitpid(-1, NULL, WNOHANG));
-}
-
 void
 unmanage(Client *c, int destroyed)
 {
@@ -828,6 +946,8 @@ unmanage(Client *c, int destroyed)
 
 	P_DEBUG("%s(%p, %d)\n", __func__, (void *) c, destroyed);
 	detach(c);
+	clientlist_rm(c->win);
+	ipc_event(IPC_EVENT_DESTROY, c->win);
 	if (!destroyed) {
 		wc.border_width = c->oldbw;
 		XGrabServer(dpy);                                       /* avoid race conditions */
@@ -841,9 +961,8 @@ unmanage(Client *c, int destroyed)
 	}
 	free(c);
 	client_focus(NULL);
-	updateclientlist();
 	// This could run only on the relevant monitor:
-	list_run_for_all(&mons, mon_arrange_cb, NULL);
+	list_run_for_all(&mons, mon_arrange_schedule_cb, NULL);
 }
 
 void
@@ -880,9 +999,13 @@ updatebars(void)
 	};
 	XClassHint ch = { "dwm", "dwm" };
 
-	for (m = mons; m; m = m->next) {
-		if (m->barwin)
+	for (int i = 0; i < mons.size; i++) {
+		m = list_data_handle_get(&mons, i);
+		if (m->barwin) {
+			// The monitor geometry may have changed
+			XMoveResizeWindow(dpy, m->barwin, m->wx, m->by, m->ww, bar_h);
 			continue;
+		}
 		m->barwin = XCreateWindow(dpy, root, m->wx, m->by, m->ww, bar_h, 0, DefaultDepth(dpy, screen),
 					  CopyFromParent, DefaultVisual(dpy, screen),
 					  CWOverrideRedirect | CWBackPixmap | CWEventMask, &wa);
@@ -894,23 +1017,6 @@ updatebars(void)
 }
 
 
-static void
-client_list_update(void *data, void *storage)
-{
-	struct Client *c = (struct Client *) data;
-
-	XChangeProperty(dpy, root, netatom[NetClientList],
-			XA_WINDOW, 32, PropModeAppend,
-			(unsigned char *) &(c->win), 1);
-}
-
-void
-updateclientlist()
-{
-	XDeleteProperty(dpy, root, netatom[NetClientList]);
-	tagview_run_for_all_tv_all_clients(client_list_update);
-}
-
 struct xinerama_screen_info {
 	int current_num;
 	XineramaScreenInfo *unique;
@@ -939,24 +1045,12 @@ static void update_mons_with_new(void *data, void *storage)
 	}
 }
 
-static bool
-monitor_has_tagview(void *monitor, void *tagview)
-{
-	struct Monitor *m = (struct Monitor *) monitor;
-	struct tagview *tv = (struct tagview *) tagview;
-
-	return m->tagview == tv;
-}
-
 static struct tagview *
 undisplayed_tagview_get(void)
 {
 	int tv_index = 0;
 
-	while (list_find(
-		       &mons,
-		       monitor_has_tagview,
-		       tagview_get(tv_index))) {
+	while (tagview_get(tv_index)->mon != NULL) {
 		tv_index++;
 	}
 	return tagview_get(tv_index);
@@ -1074,7 +1168,7 @@ updategeom(void)
 		}
 	}
 	if (dirty) {
-		selmon = mons.head->data;
+		selmon = list_data_handle_get(&mons, 0);
 	}
 	return dirty;
 }
@@ -1085,30 +1179,23 @@ wintoclient(Window w)
 	return tagviews_find_window_client(&w);
 }
 
-static bool
-window_is_barwin(void *monitor, void *window)
-{
-	struct Monitor *m = monitor;
-	Window *w = window;
-
-	return *w == m->barwin;
-}
-
 struct Monitor *
 wintomon(Window w)
 {
 	int x, y;
+	Client *c;
 	Monitor *m;
 
 	if (w == root && getrootptr(&x, &y))
 		return recttomon(x, y, 1, 1);
 
-	m = list_find(&mons, window_is_barwin, &w);
-	if (m)
-		return m;
+	LIST_FOR_EACH(m, &mons) {
+		if (w == m->barwin)
+			return m;
+	}
 
-	m = list_find(&mons, mon_has_window, &w);
-	if (m)
+	c = wintoclient(w);
+	if (c && (m = client_mon_get(c)))
 		return m;
 
 	return selmon;
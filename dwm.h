@@ -20,6 +20,8 @@ enum {
 	NetWMWindowType,
 	NetWMWindowTypeDialog,
 	NetClientList,
+	NetClientListStacking,
+	NetWMPid,
 	NetLast
 }; /* EWMH atoms */
 
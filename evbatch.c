@@ -0,0 +1,215 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <X11/Xlib.h>
+
+#include "evbatch.h"
+
+#include "debug.h"
+#include "util.h"
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+// Coalescing looks back linearly through the batch, a bounded batch keeps that
+// cheap. Events beyond it stay queued in Xlib for the next batch.
+#define BATCH_MAX 512
+
+//******************************************************************************
+// Module types
+//******************************************************************************
+struct batch_event {
+	XEvent ev;
+	bool dropped;
+};
+
+//******************************************************************************
+// Module variables
+//******************************************************************************
+static struct batch_event *events;
+static int size;
+static int next;
+static struct evbatch_stats stats;
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static Window event_window(const XEvent *ev);
+static bool is_barrier(const XEvent *ev);
+static bool ends_collection(const XEvent *ev);
+static struct batch_event *earlier_find(const XEvent *ev);
+static void configure_merge(XConfigureRequestEvent *dst, const XConfigureRequestEvent *src);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+void evbatch_collect(Display *dpy, const XEvent *first)
+{
+	XEvent ev;
+
+	assert(next == size);
+
+	size = next = 0;
+	stats.batches++;
+	evbatch_push(first);
+	if (ends_collection(first)) {
+		P_DEBUG("%s: 1 event\n", __func__);
+		return;
+	}
+	while (size < BATCH_MAX && XPending(dpy)) {
+		XNextEvent(dpy, &ev);
+		evbatch_push(&ev);
+		if (ends_collection(&ev)) {
+			break;
+		}
+	}
+	P_DEBUG("%s: %d events\n", __func__, size);
+}
+
+void evbatch_push(const XEvent *ev)
+{
+	struct batch_event *earlier;
+
+	if (events == NULL) {
+		events = ecalloc(BATCH_MAX, sizeof(*events));
+	}
+	assert(size < BATCH_MAX);
+
+	stats.received++;
+	events[size] = (struct batch_event) {
+		.ev = *ev,
+		.dropped = false
+	};
+
+	earlier = earlier_find(ev);
+	if (earlier != NULL) {
+		if (ev->type == ConfigureRequest) {
+			configure_merge(
+				&earlier->ev.xconfigurerequest,
+				&events[size].ev.xconfigurerequest);
+			events[size].ev.xconfigurerequest = earlier->ev.xconfigurerequest;
+			stats.coalesced_configure++;
+		} else {
+			stats.coalesced_property++;
+		}
+		earlier->dropped = true;
+	}
+	size++;
+}
+
+bool evbatch_next(XEvent *ev)
+{
+	while (next < size) {
+		struct batch_event *e = &events[next++];
+
+		if (!e->dropped) {
+			*ev = e->ev;
+			stats.dispatched++;
+			return true;
+		}
+	}
+	return false;
+}
+
+const struct evbatch_stats *evbatch_stats_get(void)
+{
+	return &stats;
+}
+
+void evbatch_clear(void)
+{
+	free(events);
+	events = NULL;
+	size = next = 0;
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static Window event_window(const XEvent *ev)
+{
+	switch (ev->type) {
+	case PropertyNotify:
+		return ev->xproperty.window;
+	case ConfigureRequest:
+		return ev->xconfigurerequest.window;
+	case MapRequest:
+		return ev->xmaprequest.window;
+	case UnmapNotify:
+		return ev->xunmap.window;
+	case DestroyNotify:
+		return ev->xdestroywindow.window;
+	default:
+		return None;
+	}
+}
+
+static bool is_barrier(const XEvent *ev)
+{
+	return ev->type == MapRequest
+	       || ev->type == UnmapNotify
+	       || ev->type == DestroyNotify;
+}
+
+// The handlers of ButtonPress and KeyPress may run their own event loop, e.g.
+// drag_run() waiting for the ButtonRelease. The events after them must stay
+// queued in Xlib for that loop: read into the batch, a release would never be
+// seen there, and batched motion would be dispatched after the drag.
+static bool ends_collection(const XEvent *ev)
+{
+	return ev->type == ButtonPress || ev->type == KeyPress;
+}
+
+// Find a not yet dropped event of the batch that ev makes redundant.
+static struct batch_event *earlier_find(const XEvent *ev)
+{
+	Window w;
+
+	if (ev->type != PropertyNotify && ev->type != ConfigureRequest) {
+		return NULL;
+	}
+
+	w = event_window(ev);
+	for (int i = size - 1; i >= next; i--) {
+		struct batch_event *e = &events[i];
+
+		if (e->dropped || event_window(&e->ev) != w) {
+			continue;
+		}
+		if (is_barrier(&e->ev)) {
+			return NULL;
+		}
+		if (e->ev.type != ev->type) {
+			continue;
+		}
+		if (ev->type == ConfigureRequest
+		    || e->ev.xproperty.atom == ev->xproperty.atom) {
+			return e;
+		}
+	}
+	return NULL;
+}
+
+// Merge the earlier request dst into the later src: fields only dst sets are
+// copied to src, then src is copied back to dst.
+static void configure_merge(XConfigureRequestEvent *dst, const XConfigureRequestEvent *src)
+{
+	XConfigureRequestEvent merged = *src;
+	unsigned long only_dst = dst->value_mask & ~src->value_mask;
+
+	if (only_dst & CWX)
+		merged.x = dst->x;
+	if (only_dst & CWY)
+		merged.y = dst->y;
+	if (only_dst & CWWidth)
+		merged.width = dst->width;
+	if (only_dst & CWHeight)
+		merged.height = dst->height;
+	if (only_dst & CWBorderWidth)
+		merged.border_width = dst->border_width;
+	if (only_dst & CWSibling)
+		merged.above = dst->above;
+	if (only_dst & CWStackMode)
+		merged.detail = dst->detail;
+	merged.value_mask |= dst->value_mask;
+	*dst = merged;
+}
@@ -0,0 +1,54 @@
+#ifndef EVBATCH_H
+#define EVBATCH_H
+
+#include <stdbool.h>
+#include <X11/Xlib.h>
+
+// Batching of X events. All events already received are read at once, and
+// redundant ones are dropped before dispatching:
+// - A PropertyNotify is dropped if a later one in the batch is for the same
+//   window and atom. The handlers read the property again anyway, so only the
+//   last change matters.
+// - A ConfigureRequest is merged into a later one for the same window. The
+//   merged request keeps the value of every field set in any of them, the
+//   latest winning, and takes the position of the latest in the batch.
+// Events are never coalesced across a MapRequest, UnmapNotify or DestroyNotify
+// for the same window. A ButtonPress or KeyPress ends the batch, the events
+// after it stay queued for the handler.
+
+struct evbatch_stats {
+	unsigned long batches;             // Batches read.
+	unsigned long received;            // Events read from the display.
+	unsigned long dispatched;          // Events returned by evbatch_next().
+	unsigned long coalesced_property;  // PropertyNotify dropped.
+	unsigned long coalesced_configure; // ConfigureRequest merged.
+};
+
+//  ----------------------------------------------------------------------------
+/// \brief  Start a batch with an event, and append all events pending on the
+/// display, without blocking. Must only be called once the previous batch is
+/// fully consumed with evbatch_next().
+/// \param  first  Event that was read with XNextEvent().
+//  ----------------------------------------------------------------------------
+void evbatch_collect(Display *dpy, const XEvent *first);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Append an event to the current batch, coalescing it with the
+/// events already there.
+//  ----------------------------------------------------------------------------
+void evbatch_push(const XEvent *ev);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Get the next event of the batch to dispatch, in order.
+/// \return False once the batch is consumed.
+//  ----------------------------------------------------------------------------
+bool evbatch_next(XEvent *ev);
+
+const struct evbatch_stats *evbatch_stats_get(void);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Free the batch storage.
+//  ----------------------------------------------------------------------------
+void evbatch_clear(void);
+
+#endif
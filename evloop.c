@@ -0,0 +1,170 @@
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+#include "evloop.h"
+
+#include "util.h"
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+#define WATCHES_MAX 32
+
+//******************************************************************************
+// Module types
+//******************************************************************************
+struct watch {
+	int fd;
+	evloop_callback_t callback;
+	void *data;
+	bool is_timer;
+};
+
+//******************************************************************************
+// Module variables
+//******************************************************************************
+static struct watch watches[WATCHES_MAX];
+static int n_watches;
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static struct watch *watch_find(int fd);
+static void timer_expired(int fd, void *data);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+void evloop_fd_add(int fd, evloop_callback_t callback, void *data)
+{
+	assert(fd >= 0);
+	assert(watch_find(fd) == NULL);
+
+	if (n_watches == WATCHES_MAX) {
+		die("evloop: more than %d file descriptors", WATCHES_MAX);
+	}
+	watches[n_watches++] = (struct watch) {
+		.fd = fd,
+		.callback = callback,
+		.data = data
+	};
+}
+
+void evloop_fd_rm(int fd)
+{
+	struct watch *w = watch_find(fd);
+
+	if (w != NULL) {
+		*w = watches[--n_watches];
+	}
+}
+
+bool evloop_wait(int fd)
+{
+	struct pollfd fds[WATCHES_MAX + 1];
+	int n_fds = n_watches;
+	bool fd_ready;
+
+	for (int i = 0; i < n_watches; i++) {
+		fds[i] = (struct pollfd) { .fd = watches[i].fd, .events = POLLIN };
+	}
+	fds[n_fds++] = (struct pollfd) { .fd = fd, .events = POLLIN };
+
+	if (poll(fds, n_fds, -1) < 0) {
+		if (errno != EINTR) {
+			die("poll:");
+		}
+		return false;
+	}
+
+	// Callbacks may add or remove watches, they are looked up again.
+	for (int i = 0; i < n_fds - 1; i++) {
+		struct watch *w;
+
+		if (fds[i].revents == 0 || (w = watch_find(fds[i].fd)) == NULL) {
+			continue;
+		}
+		if (w->is_timer) {
+			timer_expired(w->fd, w);
+		} else {
+			w->callback(w->fd, w->data);
+		}
+	}
+
+	fd_ready = fds[n_fds - 1].revents != 0;
+	return fd_ready;
+}
+
+int evloop_timer_create(evloop_callback_t callback, void *data)
+{
+	int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+
+	if (fd < 0) {
+		die("timerfd_create:");
+	}
+	evloop_fd_add(fd, callback, data);
+	watch_find(fd)->is_timer = true;
+	return fd;
+}
+
+void evloop_timer_set(int timer, unsigned int ms, bool repeat)
+{
+	struct timespec t = {
+		.tv_sec = ms / 1000,
+		.tv_nsec = (ms % 1000) * 1000000L
+	};
+	struct itimerspec spec = {
+		.it_value = t,
+		.it_interval = repeat ? t : (struct timespec) { 0 }
+	};
+
+	if (timerfd_settime(timer, 0, &spec, NULL) < 0) {
+		die("timerfd_settime:");
+	}
+}
+
+void evloop_timer_destroy(int timer)
+{
+	evloop_fd_rm(timer);
+	close(timer);
+}
+
+void evloop_clear(void)
+{
+	while (n_watches > 0) {
+		struct watch *w = &watches[n_watches - 1];
+
+		if (w->is_timer) {
+			close(w->fd);
+		}
+		n_watches--;
+	}
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static struct watch *watch_find(int fd)
+{
+	for (int i = 0; i < n_watches; i++) {
+		if (watches[i].fd == fd) {
+			return &watches[i];
+		}
+	}
+	return NULL;
+}
+
+static void timer_expired(int fd, void *data)
+{
+	struct watch *w = data;
+	uint64_t expirations;
+
+	if (read(fd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+		return; // Rearmed or disarmed since poll() returned
+	}
+	w->callback(fd, w->data);
+}
@@ -0,0 +1,54 @@
+#ifndef EVLOOP_H
+#define EVLOOP_H
+
+#include <stdbool.h>
+
+// Event loop multiplexing file descriptors with poll(). Besides the X
+// connection, which run() handles itself, it watches the other inputs of the
+// window manager: the status FIFO, timers, and SIGCHLD through a signalfd, see
+// proc.h.
+
+typedef void (*evloop_callback_t)(int fd, void *data);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Watch a file descriptor for input.
+/// \param  callback  Called with fd and data from evloop_wait() when fd is
+/// readable, or has hung up or failed.
+//  ----------------------------------------------------------------------------
+void evloop_fd_add(int fd, evloop_callback_t callback, void *data);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Stop watching a file descriptor. It is not closed. May be called
+/// from a callback.
+//  ----------------------------------------------------------------------------
+void evloop_fd_rm(int fd);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Wait until one of the watched file descriptors, or the additional
+/// one passed as parameter, has input, and call the callbacks of those ready.
+/// \param  fd  Also wait for this one, without callback. -1 for none.
+/// \return True if the additional fd is readable.
+//  ----------------------------------------------------------------------------
+bool evloop_wait(int fd);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Create a timer, initially disarmed.
+/// \param  callback  Called with the timer and data each time it expires.
+/// \return The timer, a file descriptor watched by the loop.
+//  ----------------------------------------------------------------------------
+int evloop_timer_create(evloop_callback_t callback, void *data);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Arm the timer to expire after ms milliseconds, and then every ms
+/// milliseconds if repeat is set. 0 disarms it.
+//  ----------------------------------------------------------------------------
+void evloop_timer_set(int timer, unsigned int ms, bool repeat);
+
+void evloop_timer_destroy(int timer);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Close the timers, and stop watching everything.
+//  ----------------------------------------------------------------------------
+void evloop_clear(void);
+
+#endif
@@ -0,0 +1,588 @@
+#define _GNU_SOURCE // accept4(), memrchr()
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "ipc.h"
+
+#include "client.h"
+#include "config.h"
+#include "debug.h"
+#include "dwm.h"
+#include "evloop.h"
+#include "monitor.h"
+#include "tagview.h"
+#include "ui.h"
+#include "util.h"
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+#define CONNS_MAX 8
+#define BUF_SIZE 4096 // Longest request, bytes received but not yet handled
+#define NAME_MAX_LENGTH 32
+#define PENDING_MAX 256 // Events recorded in one loop iteration
+
+//******************************************************************************
+// Module types
+//******************************************************************************
+enum arg_type {
+	ARG_NONE,
+	ARG_INT,
+	ARG_FLOAT,
+	ARG_TAG // Index of a tag, checked against tags[]
+};
+
+struct command {
+	const char *name;
+	void (*func)(const Arg *arg);
+	enum arg_type arg_type;
+};
+
+enum query {
+	QUERY_NONE, // The line is a command
+	QUERY_MONITORS,
+	QUERY_CLIENTS,
+	QUERY_SUBSCRIBE
+};
+
+struct line {
+	const struct command *command;
+	Arg arg;
+	enum query query;
+	unsigned int events; // QUERY_SUBSCRIBE: bit (1 << e) per ipc_event
+};
+
+struct conn {
+	int fd; // -1 if the slot is free
+	unsigned int events; // Subscribed, bit (1 << e) per ipc_event
+	size_t length;
+	char buf[BUF_SIZE];
+};
+
+struct pending {
+	enum ipc_event event;
+	unsigned long id;
+};
+
+//******************************************************************************
+// Module variables
+//******************************************************************************
+// Actions that make sense without a pointer: movemouse and resizemouse need
+// a button press, spawn is left to the scripts themselves. togglefloating and
+// setlayout are not implemented yet, they would reply "ok" doing nothing.
+static const struct command commands[] = {
+	{ "tag_view",       tag_view,       ARG_TAG   },
+	{ "tag_send",       tag_send,       ARG_TAG   },
+	{ "monitor_focus",  monitor_focus,  ARG_INT   },
+	{ "focusstack",     focusstack,     ARG_INT   },
+	{ "incnmaster",     incnmaster,     ARG_INT   },
+	{ "setmfact",       setmfact,       ARG_FLOAT },
+	{ "killclient",     killclient,     ARG_NONE  },
+	{ "to_master_send", to_master_send, ARG_NONE  },
+	{ "togglebar",      togglebar,      ARG_NONE  },
+	{ "quit",           quit,           ARG_NONE  },
+};
+
+static const char *const event_names[IPC_EVENT_LAST] = {
+	[IPC_EVENT_FOCUS] = "focus",
+	[IPC_EVENT_TAGVIEW] = "tagview",
+	[IPC_EVENT_CREATE] = "create",
+	[IPC_EVENT_DESTROY] = "destroy",
+	[IPC_EVENT_TITLE] = "title",
+	[IPC_EVENT_LAYOUT] = "layout",
+};
+
+static int listen_fd = -1;
+static char *socket_path;
+static struct conn conns[CONNS_MAX];
+static unsigned int subscribed; // Union of the conns events
+static struct pending pending[PENDING_MAX];
+static int n_pending;
+static bool overflow; // Events were lost, subscribers must query again
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static void listen_readable(int fd, void *data);
+static void conn_readable(int fd, void *data);
+static void conn_close(struct conn *c);
+static void transaction_run(struct conn *c, char *lines, size_t length);
+static const char *line_parse(const char *text, struct line *line);
+static void query_answer(FILE *out, struct conn *c, const struct line *line);
+static void monitor_print(void *monitor, void *out);
+static void client_print(void *client, void *out);
+static void subscribed_update(void);
+static void event_print(FILE *out, const struct pending *p);
+static void json_string_print(FILE *out, const char *s);
+static bool mon_has_num(void *monitor, void *num);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+bool ipc_open(const char *path)
+{
+	struct sockaddr_un addr = { .sun_family = AF_UNIX };
+
+	if (strlen(path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "dwm: ipc socket path too long: %s\n", path);
+		return false;
+	}
+	strcpy(addr.sun_path, path);
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listen_fd < 0) {
+		perror("dwm: ipc socket failed");
+		return false;
+	}
+	// A socket left by a previous instance would make bind() fail.
+	unlink(path);
+	if (bind(listen_fd, (struct sockaddr *) &addr, sizeof(addr)) < 0
+	    || listen(listen_fd, CONNS_MAX) < 0) {
+		fprintf(stderr, "dwm: ipc socket %s", path);
+		perror(" failed");
+		close(listen_fd);
+		listen_fd = -1;
+		return false;
+	}
+
+	socket_path = strdup(path);
+	for (int i = 0; i < CONNS_MAX; i++) {
+		conns[i].fd = -1;
+	}
+	evloop_fd_add(listen_fd, listen_readable, NULL);
+	return true;
+}
+
+void ipc_event(enum ipc_event event, unsigned long id)
+{
+	if (!(subscribed & 1u << event)) {
+		return;
+	}
+	if (event == IPC_EVENT_FOCUS) {
+		id = 0; // A single focus, the current one is sent
+	}
+	for (int i = 0; i < n_pending; i++) {
+		if (pending[i].event == event && pending[i].id == id) {
+			return;
+		}
+	}
+	if (n_pending == PENDING_MAX) {
+		overflow = true;
+		return;
+	}
+	pending[n_pending++] = (struct pending) { .event = event, .id = id };
+}
+
+void ipc_events_publish(void)
+{
+	char *buf = NULL;
+	size_t size = 0;
+	FILE *out;
+
+	if (n_pending == 0 && !overflow) {
+		return;
+	}
+	P_DEBUG("%s: %d events%s\n", __func__, n_pending, overflow ? ", overflow" : "");
+
+	// Each subscriber gets the lines of its events, from a single
+	// formatting of all of them.
+	for (int i = 0; i < CONNS_MAX; i++) {
+		struct conn *c = &conns[i];
+
+		if (c->fd < 0 || c->events == 0) {
+			continue;
+		}
+		out = open_memstream(&buf, &size);
+		if (out == NULL) {
+			break;
+		}
+		if (overflow) {
+			fprintf(out, "{\"event\":\"overflow\"}\n");
+		}
+		for (int j = 0; j < n_pending; j++) {
+			if (c->events & 1u << pending[j].event) {
+				event_print(out, &pending[j]);
+			}
+		}
+		fclose(out);
+		// A subscriber that does not keep up is dropped, rather than
+		// blocking the window manager or buffering without bounds.
+		if (size > 0 && send(c->fd, buf, size, MSG_NOSIGNAL | MSG_DONTWAIT)
+		    != (ssize_t) size) {
+			conn_close(c);
+		}
+		free(buf);
+		buf = NULL;
+	}
+	n_pending = 0;
+	overflow = false;
+}
+
+void ipc_close(void)
+{
+	if (listen_fd < 0) {
+		return;
+	}
+	for (int i = 0; i < CONNS_MAX; i++) {
+		conn_close(&conns[i]);
+	}
+	evloop_fd_rm(listen_fd);
+	close(listen_fd);
+	listen_fd = -1;
+	unlink(socket_path);
+	free(socket_path);
+	socket_path = NULL;
+	n_pending = 0;
+	overflow = false;
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static void listen_readable(int fd, void *data)
+{
+	struct conn *c = NULL;
+	int conn_fd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+	if (conn_fd < 0) {
+		return;
+	}
+	for (int i = 0; i < CONNS_MAX && c == NULL; i++) {
+		if (conns[i].fd < 0) {
+			c = &conns[i];
+		}
+	}
+	if (c == NULL) {
+		dprintf(conn_fd, "error too many connections\n");
+		close(conn_fd);
+		return;
+	}
+	c->fd = conn_fd;
+	c->events = 0;
+	c->length = 0;
+	evloop_fd_add(conn_fd, conn_readable, c);
+}
+
+static void conn_readable(int fd, void *data)
+{
+	struct conn *c = data;
+	ssize_t n;
+	char *end;
+
+	n = read(fd, c->buf + c->length, sizeof(c->buf) - c->length);
+	if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+		conn_close(c);
+		return;
+	}
+	if (n < 0) {
+		return;
+	}
+	c->length += n;
+
+	// Everything up to the last newline is one transaction, a partial
+	// line waits for the next read.
+	end = memrchr(c->buf, '\n', c->length);
+	if (end == NULL) {
+		if (c->length == sizeof(c->buf)) {
+			dprintf(fd, "error line too long\n");
+			conn_close(c);
+		}
+		return;
+	}
+	end++;
+	transaction_run(c, c->buf, end - c->buf);
+	if (c->fd < 0) {
+		return;
+	}
+	c->length -= end - c->buf;
+	memmove(c->buf, end, c->length);
+}
+
+static void conn_close(struct conn *c)
+{
+	if (c->fd < 0) {
+		return;
+	}
+	evloop_fd_rm(c->fd);
+	close(c->fd);
+	c->fd = -1;
+	c->length = 0;
+	if (c->events != 0) {
+		c->events = 0;
+		subscribed_update();
+	}
+}
+
+static void transaction_run(struct conn *c, char *lines, size_t length)
+{
+	struct line line;
+	const char *error = NULL;
+	char *reply = NULL;
+	size_t reply_size = 0;
+	FILE *out;
+	char *text;
+	int n_lines = 0;
+	P_INT(n_commands = 0);
+
+	// Lines become strings, walked with strlen().
+	for (size_t i = 0; i < length; i++) {
+		if (lines[i] == '\n') {
+			lines[i] = '\0';
+			n_lines++;
+		}
+	}
+
+	out = open_memstream(&reply, &reply_size);
+	if (out == NULL) {
+		conn_close(c);
+		return;
+	}
+
+	text = lines;
+	for (int i = 0; i < n_lines && error == NULL; i++) {
+		error = line_parse(text, &line);
+		if (error != NULL) {
+			fprintf(out, "error line %d: %s\n", i + 1, error);
+		}
+		text += strlen(text) + 1;
+	}
+
+	if (error == NULL) {
+		text = lines;
+		for (int i = 0; i < n_lines; i++) {
+			line_parse(text, &line);
+			if (line.command != NULL) {
+				line.command->func(&line.arg);
+#if defined(DEBUG)
+				n_commands++;
+#endif
+			}
+			text += strlen(text) + 1;
+		}
+		// The commands only scheduled their work, the queries must
+		// see it done.
+		mon_flush_all(&mons);
+		text = lines;
+		for (int i = 0; i < n_lines; i++) {
+			line_parse(text, &line);
+			query_answer(out, c, &line);
+			fprintf(out, "ok\n");
+			text += strlen(text) + 1;
+		}
+	}
+	fclose(out);
+	P_DEBUG("%s: %d lines, %d commands run\n", __func__, n_lines, n_commands);
+
+	// The replies are short, a client that does not read them is dropped
+	// rather than buffered for.
+	if (send(c->fd, reply, reply_size, MSG_NOSIGNAL) != (ssize_t) reply_size) {
+		conn_close(c);
+	}
+	free(reply);
+}
+
+// \return NULL if the line is valid, the reason otherwise.
+static const char *line_parse(const char *text, struct line *line)
+{
+	char name[NAME_MAX_LENGTH];
+	char *end;
+	int n = 0;
+
+	memset(line, 0, sizeof(*line));
+	if (sscanf(text, "%31s %n", name, &n) != 1) {
+		return "empty line";
+	}
+	text += n;
+
+	if (strcmp(name, "monitors") == 0) {
+		line->query = QUERY_MONITORS;
+	} else if (strcmp(name, "clients") == 0) {
+		line->query = QUERY_CLIENTS;
+	} else if (strcmp(name, "subscribe") == 0) {
+		line->query = QUERY_SUBSCRIBE;
+		while (sscanf(text, "%31s %n", name, &n) == 1) {
+			int e = 0;
+
+			while (e < IPC_EVENT_LAST && strcmp(name, event_names[e]) != 0) {
+				e++;
+			}
+			if (e == IPC_EVENT_LAST) {
+				return "unknown event";
+			}
+			line->events |= 1u << e;
+			text += n;
+		}
+		if (line->events == 0) {
+			line->events = (1u << IPC_EVENT_LAST) - 1;
+		}
+	}
+	for (unsigned int i = 0; i < LENGTH(commands) && line->query == QUERY_NONE; i++) {
+		if (strcmp(name, commands[i].name) == 0) {
+			line->command = &commands[i];
+		}
+	}
+	if (line->query == QUERY_NONE && line->command == NULL) {
+		return "unknown command";
+	}
+
+	switch (line->command != NULL ? line->command->arg_type : ARG_NONE) {
+	case ARG_NONE:
+		end = (char *) text;
+		break;
+	case ARG_INT:
+		line->arg.i = strtol(text, &end, 10);
+		break;
+	case ARG_FLOAT:
+		line->arg.f = strtof(text, &end);
+		break;
+	case ARG_TAG:
+		line->arg.ui = strtoul(text, &end, 10);
+		if (end != text && (line->arg.ui >= (unsigned int) num_tags
+				    || tags[line->arg.ui] == NULL)) {
+			return "no such tag";
+		}
+		break;
+	}
+	if (line->command != NULL && line->command->arg_type != ARG_NONE && end == text) {
+		return "missing argument";
+	}
+	while (*end == ' ' || *end == '\t') {
+		end++;
+	}
+	if (*end != '\0') {
+		return "unexpected argument";
+	}
+	return NULL;
+}
+
+static void query_answer(FILE *out, struct conn *c, const struct line *line)
+{
+	switch (line->query) {
+	case QUERY_NONE:
+		break;
+	case QUERY_MONITORS:
+		list_run_for_all(&mons, monitor_print, out);
+		break;
+	case QUERY_CLIENTS:
+		for (int i = 0; i < num_tags && tags[i] != NULL; i++) {
+			list_run_for_all(&tagview_get(i)->clients, client_print, out);
+		}
+		break;
+	case QUERY_SUBSCRIBE:
+		c->events = line->events;
+		subscribed_update();
+		break;
+	}
+}
+
+static void monitor_print(void *monitor, void *out)
+{
+	struct Monitor *m = monitor;
+
+	fprintf(out, "monitor %d %d %d %d %d tag %d selected %d\n",
+		m->num, m->mx, m->my, m->mw, m->mh,
+		m->tagview->index,
+		m == selmon);
+}
+
+static void client_print(void *client, void *out)
+{
+	struct Client *c = client;
+
+	fprintf(out, "client 0x%lx tag %d %d %d %d %d floating %d focused %d ",
+		c->win,
+		c->tagview->index,
+		c->x, c->y, c->w, c->h,
+		c->isfloating,
+		c == mon_selected_client_get(selmon));
+	// The name ends the line, and must not break it.
+	for (const char *s = c->name; *s != '\0'; s++) {
+		fputc((unsigned char) *s < ' ' ? ' ' : *s, out);
+	}
+	fputc('\n', out);
+}
+
+static void subscribed_update(void)
+{
+	subscribed = 0;
+	for (int i = 0; i < CONNS_MAX; i++) {
+		if (conns[i].fd >= 0) {
+			subscribed |= conns[i].events;
+		}
+	}
+}
+
+// The payload is read when the event is sent, the state it describes may be
+// gone by then: the window destroyed, or the monitor removed.
+static void event_print(FILE *out, const struct pending *p)
+{
+	struct Client *c;
+	struct Monitor *m;
+
+	fprintf(out, "{\"event\":\"%s\"", event_names[p->event]);
+	switch (p->event) {
+	case IPC_EVENT_FOCUS:
+		c = mon_selected_client_get(selmon);
+		if (c != NULL) {
+			fprintf(out, ",\"window\":\"0x%lx\"", c->win);
+		} else {
+			fprintf(out, ",\"window\":null");
+		}
+		fprintf(out, ",\"monitor\":%d", selmon->num);
+		break;
+	case IPC_EVENT_CREATE:
+	case IPC_EVENT_DESTROY:
+	case IPC_EVENT_TITLE:
+		fprintf(out, ",\"window\":\"0x%lx\"", p->id);
+		c = p->event != IPC_EVENT_DESTROY ? wintoclient(p->id) : NULL;
+		if (c != NULL) {
+			fprintf(out, ",\"name\":");
+			json_string_print(out, c->name);
+		}
+		break;
+	case IPC_EVENT_TAGVIEW:
+	case IPC_EVENT_LAYOUT:
+		fprintf(out, ",\"monitor\":%lu", p->id);
+		m = list_find(&mons, mon_has_num, (void *) &p->id);
+		if (m == NULL) {
+			break;
+		}
+		fprintf(out, ",\"tag\":%d", m->tagview->index);
+		if (p->event == IPC_EVENT_LAYOUT) {
+			const struct layout_cfg_two_cols *cfg =
+				&m->tagview->layout_cfg_two_cols;
+
+			fprintf(out, ",\"col_ratio\":%.2f,\"n_master\":%d",
+				cfg->col_ratio, cfg->n_master);
+		}
+		break;
+	case IPC_EVENT_LAST:
+		break;
+	}
+	fprintf(out, "}\n");
+}
+
+static void json_string_print(FILE *out, const char *s)
+{
+	fputc('"', out);
+	for (; *s != '\0'; s++) {
+		if (*s == '"' || *s == '\\') {
+			fprintf(out, "\\%c", *s);
+		} else if ((unsigned char) *s < ' ') {
+			fprintf(out, "\\u%04x", (unsigned char) *s);
+		} else {
+			fputc(*s, out);
+		}
+	}
+	fputc('"', out);
+}
+
+static bool mon_has_num(void *monitor, void *num)
+{
+	return (unsigned long) ((struct Monitor *) monitor)->num == *(unsigned long *) num;
+}
@@ -0,0 +1,76 @@
+#ifndef IPC_H
+#define IPC_H
+
+#include <stdbool.h>
+#include <X11/X.h>
+
+// Command interface on a Unix domain socket, to drive the window manager from
+// scripts. Clients send newline terminated commands, the same actions as the
+// key bindings, e.g.
+//	printf 'tag_view 2\nsetmfact +0.05\n' | socat - UNIX-CONNECT:/path/to/socket
+//
+// Commands:
+//	tag_view <tag>          tag_send <tag>         monitor_focus <n>
+//	focusstack <+-n>        incnmaster <+-n>       setmfact <f>
+//	killclient              to_master_send         togglebar
+//	quit
+// The arguments mean the same as in the key bindings, see config.c.
+// Queries:
+//	monitors    one line per monitor: "monitor <num> <x> <y> <w> <h> tag
+//	            <tag> selected <0|1>"
+//	clients     one line per client: "client <window> tag <tag> <x> <y> <w>
+//	            <h> floating <0|1> focused <0|1> <name>"
+//	subscribe [<event>...]
+//	            turn the connection into an event stream, for all events or
+//	            only those named: focus, tagview, create, destroy, title,
+//	            layout. Events are JSON objects, one per line, e.g.
+//	            {"event":"title","window":"0x1a00003","name":"vim"}
+//	            layout is sent when col_ratio or n_master of the tagview
+//	            shown on a monitor changes, and carries both.
+//
+// All the complete lines received in one read are a transaction: they are all
+// parsed first, and nothing is done if one of them is invalid. Otherwise the
+// commands are run in order, the affected monitors are arranged once, and only
+// then the queries are answered, so they see the result. Each line gets its
+// reply, in order: the query output if any, then "ok". A rejected transaction
+// gets a single "error line <n>: <reason>".
+
+//  ----------------------------------------------------------------------------
+/// \brief  Create the socket, replacing a stale one, and accept connections
+/// from the event loop.
+/// \return False on failure.
+//  ----------------------------------------------------------------------------
+bool ipc_open(const char *path);
+
+// Events sent to subscribers. Each one is recorded for a window, or a monitor
+// number, and coalesced with the same event for it until ipc_events_publish().
+// Only the last state is sent: two title changes give one event with the
+// latest title.
+enum ipc_event {
+	IPC_EVENT_FOCUS,   // Focused window changed, id is ignored
+	IPC_EVENT_TAGVIEW, // Tagview shown on monitor id changed
+	IPC_EVENT_CREATE,  // Window id managed
+	IPC_EVENT_DESTROY, // Window id unmanaged
+	IPC_EVENT_TITLE,   // Name of window id changed
+	IPC_EVENT_LAYOUT,  // Layout parameters of monitor id changed
+	IPC_EVENT_LAST // Must be last
+};
+
+//  ----------------------------------------------------------------------------
+/// \brief  Record an event, for the next ipc_events_publish(). Cheap when
+/// nobody subscribed.
+//  ----------------------------------------------------------------------------
+void ipc_event(enum ipc_event event, unsigned long id);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Send the recorded events to the subscribers, once per loop
+/// iteration, after the deferred work is done.
+//  ----------------------------------------------------------------------------
+void ipc_events_publish(void);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Disconnect the clients, close and remove the socket.
+//  ----------------------------------------------------------------------------
+void ipc_close(void);
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef LAYOUT_H
 #define LAYOUT_H
 
+#include "arrange.h"
 #include "monitor.h"
 
 typedef struct layout {
@@ -8,6 +9,11 @@ typedef struct layout {
 	void (*arrange)(Monitor *);
 } Layout;
 
-typedef void (*layout_arrange_function_t)(void *layout_cfg, struct Monitor *mon);
+// Layouts do not resize clients themselves, they record the geometries in the
+// arrange transaction, see arrange.h.
+typedef void (*layout_arrange_function_t)(
+	void *layout_cfg,
+	struct Monitor *mon,
+	struct arrange_txn *txn);
 
 #endif
@@ -4,8 +4,10 @@
 
 #include "debug.h"
 #include "monitor.h"
+#include "tagview.h"
 
 struct positioning {
+	struct arrange_txn *txn;
 	const int n_masters;
 	int current_client_index;
 
@@ -20,24 +22,21 @@ struct positioning {
 	const int stack_client_h;
 };
 
-static void client_position_apply(void *client, void *storage)
+static void client_position_apply(struct Client *c, struct positioning *p)
 {
-	struct Client *c = (struct Client *) client;
-	struct positioning *p = (struct positioning *) storage;
-
 	P_DEBUG("client index %d\n", p->current_client_index);
 	if (p->current_client_index < p->n_masters) {
 		P_DEBUG("in master area\n");
 		// Master area
 		// TODO: shouldn't Client deal with border width internally?
 		// But that would disallow layouts from managing them...
-		resize(
+		arrange_geom_set(
+			p->txn,
 			c,
 			p->master_x,
 			p->current_master_y,
 			p->master_w - (2 * c->bw),
-			p->master_client_h - (2 * c->bw),
-			0
+			p->master_client_h - (2 * c->bw)
 			);
 		P_DEBUG("(x, y, w, h): (%d, %d, %d, %d)\n",
 			p->master_x,
@@ -48,13 +47,13 @@ static void client_position_apply(void *client, void *storage)
 	} else {
 		// Stack area
 		P_DEBUG("in stack area\n");
-		resize(
+		arrange_geom_set(
+			p->txn,
 			c,
 			p->master_x + p->master_w,
 			p->current_stack_y,
 			p->stack_w - (2 * c->bw),
-			p->stack_client_h - (2 * c->bw),
-			0
+			p->stack_client_h - (2 * c->bw)
 			);
 		P_DEBUG("(x, y, w, h): (%d, %d, %d, %d)\n",
 			p->master_x + p->master_w,
@@ -82,7 +81,10 @@ static void client_position_apply(void *client, void *storage)
 #endif
 }
 
-void layout_two_cols_arrange(void *layout_cfg, struct Monitor *mon)
+void layout_two_cols_arrange(
+	void *layout_cfg,
+	struct Monitor *mon,
+	struct arrange_txn *txn)
 {
 	P_DEBUG("m %p mon.xy: (%d, %d)\n", (void *) mon, mon->mx, mon->my);
 	struct layout_cfg_two_cols *cfg = layout_cfg;
@@ -103,6 +105,7 @@ void layout_two_cols_arrange(void *layout_cfg, struct Monitor *mon)
 	int n_stacked = n_clients - n_masters;
 
 	struct positioning p = {
+		.txn = txn,
 		.n_masters = n_masters,
 		.current_client_index = 0,
 
@@ -116,11 +119,11 @@ void layout_two_cols_arrange(void *layout_cfg, struct Monitor *mon)
 		.stack_w = mon->ww - master_w,
 		.stack_client_h = n_stacked > 0 ? mon->wh / n_stacked : 0,
 	};
+	struct Client *c;
 
-	list_run_for_all(
-		&mon->tagview->clients,
-		client_position_apply,
-		&p);
+	TAGVIEW_FOR_EACH_CLIENT(c, mon->tagview) {
+		client_position_apply(c, &p);
+	}
 
 #if 0
 	// This code is from dwm's `void tile(Monitor *m)`, with some of my
@@ -8,10 +8,14 @@ struct layout_cfg_two_cols {
 };
 
 
+#include "arrange.h"
 #include "monitor.h"
 
 // This prototype must match for all layouts, see struct tagview, and the
 // function pointer type layout_arrange_function_t.
-void layout_two_cols_arrange(void *layout_cfg, struct Monitor *mon);
+void layout_two_cols_arrange(
+	void *layout_cfg,
+	struct Monitor *mon,
+	struct arrange_txn *txn);
 
 #endif
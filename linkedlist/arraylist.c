@@ -0,0 +1,292 @@
+#include "linkedlist.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "debug.h"
+
+// Array backend of linkedlist.h, see there. Behaves like linkedlist.c, the
+// same tests run on both.
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+#define CAPACITY_MIN 8
+
+//******************************************************************************
+// Module variables
+//******************************************************************************
+static struct list_pool_stats stats;
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static int position_find(const struct list *list, const void *data);
+static void insert_at(struct list *list, int pos, void *data);
+static void *remove_at(struct list *list, int pos);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+void list_add(struct list *list, void *data)
+{
+	insert_at(list, list->size, data);
+}
+
+void list_prepend(struct list *list, void *data)
+{
+	insert_at(list, 0, data);
+}
+
+void list_add_before(struct list *list, void *at, void *data)
+{
+	int pos = position_find(list, at);
+
+	insert_at(list, pos < 0 ? list->size : pos, data);
+}
+
+void list_add_before_selected(struct list *list, void *data)
+{
+	insert_at(list, list->selected_pos > 0 ? list->selected_pos - 1 : 0, data);
+}
+
+void list_rm(struct list *l, void *data)
+{
+	int pos = position_find(l, data);
+
+	if (pos < 0) {
+		P_DEBUG("%s: not found\n", __func__);
+		return;
+	}
+	P_DEBUG("%s: removing\n", __func__);
+	remove_at(l, pos);
+}
+
+void *list_pop(struct list *l)
+{
+	if (l->size == 0) {
+		return NULL;
+	}
+	return remove_at(l, l->size - 1);
+}
+
+void list_destroy(struct list *list)
+{
+	if (list == NULL) {
+		return;
+	}
+	if (list->items != NULL) {
+		stats.system_frees++;
+	}
+	free(list->items);
+	list->items = NULL;
+	list->size = list->capacity = 0;
+	list->selected_pos = 0;
+}
+
+void list_run_for_all(
+	struct list *list,
+	void (*callback) (void *data, void *storage),
+	void *storage)
+{
+	if (list == NULL) {
+		return;
+	}
+	for (int i = 0; i < list->size; i++) {
+		P_DEBUG("%s: run callback on element %d\n", __func__, i);
+		callback(list->items[i], storage);
+	}
+}
+
+void *list_find(
+	struct list *list,
+	bool (*callback)(void *data, void *storage),
+	void *storage)
+{
+	for (int i = 0; i < list->size; i++) {
+		if (callback(list->items[i], storage)) {
+			return list->items[i];
+		}
+	}
+	return NULL;
+}
+
+void list_select(struct list *list, const void *data)
+{
+	int pos = position_find(list, data);
+
+	if (pos < 0) {
+		P_DEBUG("%s: data not found\n", __func__);
+		return;
+	}
+	P_DEBUG("%s: data found\n", __func__);
+	list->selected_pos = pos + 1;
+}
+
+void *list_head_select(struct list *list)
+{
+	list->selected_pos = list->size > 0 ? 1 : 0;
+	return list_selected_data_get(list);
+}
+
+void *list_tail_select(struct list *l)
+{
+	l->selected_pos = l->size;
+	return list_selected_data_get(l);
+}
+
+void *list_next_select(struct list *list)
+{
+	if (list->selected_pos == 0) {
+		return list_head_select(list);
+	}
+	if (list->selected_pos < list->size) {
+		list->selected_pos++;
+	}
+	return list_selected_data_get(list);
+}
+
+void *list_prev_select(struct list *l)
+{
+	if (l->size <= 1 || l->selected_pos == 0) {
+		return list_head_select(l);
+	}
+	// No wrap around if the head is selected.
+	if (l->selected_pos > 1) {
+		l->selected_pos--;
+	}
+	return list_selected_data_get(l);
+}
+
+void *list_next_wrap_select(struct list *l)
+{
+	if (l->selected_pos > 0 && l->selected_pos == l->size) {
+		return list_head_select(l);
+	}
+	return list_next_select(l);
+}
+
+void *list_prev_wrap_select(struct list *l)
+{
+	if (l->selected_pos == 1) {
+		return list_tail_select(l);
+	}
+	return list_prev_select(l);
+}
+
+void *list_selected_data_get(struct list *list)
+{
+	if (list == NULL || list->selected_pos == 0) {
+		return NULL;
+	}
+	return list->items[list->selected_pos - 1];
+}
+
+void list_data_swap(struct list *list, void *a, void *b)
+{
+	int first, second;
+
+	for (first = 0;
+	     first < list->size && list->items[first] != a && list->items[first] != b;
+	     first++) {
+	}
+	for (second = first + 1;
+	     second < list->size && list->items[second] != a && list->items[second] != b;
+	     second++) {
+	}
+	if (second >= list->size) {
+		return;
+	}
+
+	void *tmp = list->items[first];
+
+	list->items[first] = list->items[second];
+	list->items[second] = tmp;
+}
+
+void *list_data_handle_get(
+	struct list * const list,
+	unsigned int const position)
+{
+	if (position >= (unsigned int) list->size) {
+		return NULL;
+	}
+	return list->items[position];
+}
+
+int list_size_get(const struct list *l)
+{
+	return l->size;
+}
+
+void list_arena_init(struct list_arena *arena, struct ll_node *nodes, int capacity)
+{
+	arena->nodes = nodes;
+	arena->capacity = capacity;
+	arena->free = NULL;
+}
+
+const struct list_pool_stats *list_pool_stats_get(void)
+{
+	return &stats;
+}
+
+void list_pool_clear(void)
+{
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static int position_find(const struct list *list, const void *data)
+{
+	for (int i = 0; i < list->size; i++) {
+		if (list->items[i] == data) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// The selected element stays selected, wherever it moves.
+static void insert_at(struct list *list, int pos, void *data)
+{
+	if (list->size == list->capacity) {
+		int capacity = list->capacity > 0 ? 2 * list->capacity : CAPACITY_MIN;
+		void **items = realloc(list->items, capacity * sizeof(*items));
+
+		assert(items);
+		stats.system_allocs++;
+		list->items = items;
+		list->capacity = capacity;
+	}
+	memmove(&list->items[pos + 1],
+		&list->items[pos],
+		(list->size - pos) * sizeof(*list->items));
+	list->items[pos] = data;
+	list->size++;
+	stats.nodes_allocated++;
+	if (list->selected_pos > pos) {
+		list->selected_pos++;
+	}
+}
+
+// Removing the selected element leaves no selection.
+static void *remove_at(struct list *list, int pos)
+{
+	void *data = list->items[pos];
+
+	list->size--;
+	memmove(&list->items[pos],
+		&list->items[pos + 1],
+		(list->size - pos) * sizeof(*list->items));
+	if (list->selected_pos == pos + 1) {
+		list->selected_pos = 0;
+	} else if (list->selected_pos > pos + 1) {
+		list->selected_pos--;
+	}
+	return data;
+}
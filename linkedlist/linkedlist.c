@@ -12,26 +12,37 @@
 //******************************************************************************
 // Module constants
 //******************************************************************************
-enum placement {
-	BEFORE,
-	AFTER
-};
-
+#define POOL_SLAB_NODES 64
+#define POOL_SLABS_MAX ((LIST_MAX_SIZE + POOL_SLAB_NODES - 1) / POOL_SLAB_NODES)
 
 //******************************************************************************
 // Module variables
 //******************************************************************************
+static struct ll_node *slabs[POOL_SLABS_MAX];
+static int n_slabs;
+static struct ll_node *pool_free; // Free nodes of the slabs, linked through next
+static int n_overflow; // Live nodes malloc()ed because the slabs were full
+static struct list_pool_stats stats;
 
 //******************************************************************************
 // Function prototypes
 //******************************************************************************
 static struct ll_node *nodes_walker(struct ll_node *start, int pos);
-
-static void list_insert_node(
+static struct ll_node *node_alloc(struct list *list);
+static void node_free(struct list *list, struct ll_node *node);
+static bool arena_owns(const struct list_arena *arena, const struct ll_node *node);
+static bool pool_owns(const struct ll_node *node);
+static struct ll_node *node_insert_before(
 	struct list *list,
-	enum placement placement,
 	struct ll_node *at,
 	void *data);
+static void node_link_before(
+	struct list *list,
+	struct ll_node *at,
+	struct ll_node *node);
+static void node_unlink(struct list *list, struct ll_node *node);
+static struct ll_node *link_of(const struct list *list, const void *data);
+static bool node_is_linked(const struct list *list, const struct ll_node *node);
 
 //******************************************************************************
 // Function definitions
@@ -46,143 +57,83 @@ static void list_insert_node(
 
 void list_add(struct list *list, void *data)
 {
-	list_insert_node(list, BEFORE, NULL, data);
+	node_insert_before(list, NULL, data);
 }
 
 void list_prepend(struct list *list, void *data)
 {
-	list_insert_node(list, BEFORE, list->head, data);
+	node_insert_before(list, list->head, data);
 }
 
 void list_add_before(struct list *list, void *at, void *data)
 {
-	struct ll_node *n;
-
-	for (
-		n = list->head;
-		n != NULL && n->next != NULL && n->next->data != at;
-		n = n->next) {
-	}
-	list_insert_node(list, AFTER, n, data);
+	// Appended if at is not found.
+	node_insert_before(list, list_node_find(list, at), data);
 }
 
 void list_add_before_selected(struct list *list, void *data)
 {
-	struct ll_node *n;
-
-	if (list->head == list->selected) {
-		list_insert_node(list, BEFORE, list->head, data);
-	} else {
-		for (
-			n = list->head;
-			n != NULL && n->next != NULL
-			&& n->next->data != list->selected->data;
-			n = n->next) {
-		}
-		list_insert_node(list, AFTER, n, data);
-	}
+	node_insert_before(
+		list,
+		list->selected != NULL ? list->selected : list->head,
+		data);
 }
 
-static void list_insert_node(
-	struct list *list,
-	enum placement placement,
-	struct ll_node *at,
-	void *data)
+void list_rm(struct list *l, void *data)
 {
-	struct ll_node *node = malloc(sizeof(struct ll_node));
+	struct ll_node *n = list_node_find(l, data);
 
-	assert(node);
-	*node = (struct ll_node) {
-		.data = data,
-		.next = NULL
-	};
+	if (n == NULL) {
+		P_DEBUG("%s: not found\n", __func__);
+		return;
+	}
+	P_DEBUG("%s: removing\n", __func__);
+	list_node_rm(l, n);
+}
 
-	if (list->head == NULL || list->size == 0) {
-		list->head = node;
-		list->size = 1;
-	} else if ((at == list->head) && (placement == BEFORE)) {
-		node->next = list->head;
-		list->head = node;
-		list->size++;
-	} else {
-		struct ll_node *n;
-		if (placement == BEFORE) {
-			// Walk to the last node, or before node `at`.
-			for (n = list->head;
-			     n->next != NULL && n->next != at;
-			     n = n->next) {
-			}
-		} else {
-			// placement == AFTER
-			n = at;
-		}
-		node->next = n->next;
-		n->next = node;
-		list->size++;
+void *list_pop(struct list *l)
+{
+	if (l->tail == NULL) {
+		return NULL;
 	}
+	return list_node_rm(l, l->tail);
 }
 
-void list_rm(struct list *l, void *data)
+struct ll_node *list_node_add(struct list *l, void *data)
+{
+	return node_insert_before(l, NULL, data);
+}
+
+struct ll_node *list_node_find(struct list *l, const void *data)
 {
 	struct ll_node *n;
-	struct ll_node *to_remove;
 
-	if (l->head->data == data) {
-		to_remove = l->head;
-		l->head = l->head->next;
-	} else {
-		for (n = l->head;
-		     n != NULL && n->next != NULL && n->next->data != data;
-		     n = n->next) {
-		}
-		if (!n || !n->next) {
-			// Not found.
-			P_DEBUG("%s: not found\n", __func__);
-			return;
-		}
-		to_remove = n->next;
-		n->next = n->next->next;
+	if (l->intrusive) {
+		n = link_of(l, data);
+		return node_is_linked(l, n) ? n : NULL;
 	}
-
-	P_DEBUG("%s: removing\n", __func__);
-
-	if (l->selected == to_remove) {
-		l->selected = NULL;
+	for (n = l->head; n != NULL && n->data != data; n = n->next) {
 	}
-
-	free(to_remove);
-	l->size--;
+	return n;
 }
 
-void *list_pop(struct list *l)
+void *list_node_rm(struct list *l, struct ll_node *node)
 {
-	if (l->head == NULL) {
-		return NULL;
-	}
-
-	if (l->head->next == NULL) {
-		/* Only one element */
-		void *data = l->head->data;
-		free(l->head);
-		l->head = NULL;
-		l->size--;
-		return data;
-	}
+	void *data = node->data;
 
-	struct ll_node *new_last;
-	for (
-		new_last = l->head;
-		new_last->next->next != NULL;
-		new_last = new_last->next) {
+	node_unlink(l, node);
+	if (l->selected == node) {
+		l->selected = NULL;
 	}
-
-	void *data = new_last->next->data;
-	free(new_last->next);
-	new_last->next = NULL;
-	l->size--;
+	node_free(l, node);
 	return data;
 }
 
+void list_node_select(struct list *l, struct ll_node *node)
+{
+	l->selected = node;
+}
+
 //  ----------------------------------------------------------------------------
 /// \brief  Free all nodes of the list passed as parameter.
 //  ----------------------------------------------------------------------------
@@ -194,10 +145,11 @@ void list_destroy(struct list *list)
 		struct ll_node *next;
 		for (struct ll_node *n = list->head; n != NULL; n = next) {
 			next = n->next;
-			free(n);
+			node_free(list, n);
 		}
 	}
-	list->head = NULL;
+	list->head = list->tail = NULL;
+	list->selected = NULL;
 	list->size = 0;
 }
 
@@ -238,12 +190,7 @@ void *list_find(
 
 void list_select(struct list *list, const void *data)
 {
-	struct ll_node *n;
-
-	for (n = list->head;
-	     n != NULL && n->data != data;
-	     n = n->next) {
-	}
+	struct ll_node *n = list_node_find(list, data);
 
 	if (n == NULL) {
 		P_DEBUG("%s: data not found\n", __func__);
@@ -264,14 +211,7 @@ void *list_head_select(struct list *list)
 
 void *list_tail_select(struct list *l)
 {
-	struct ll_node *n;
-
-	for (n = l->head;
-	     n != NULL && n->next != NULL;
-	     n = n->next) {
-	}
-
-	l->selected = n;
+	l->selected = l->tail;
 	return l->selected == NULL ? NULL : l->selected->data;
 }
 
@@ -292,16 +232,10 @@ void *list_prev_select(struct list *l)
 	    || l->head->next == NULL
 	    || l->selected == NULL) {
 		l->selected = l->head;
-	} else if (l->head == l->selected) {
+	} else if (l->selected->prev != NULL) {
 		// Don't wrap around if the head is selected. Then
 		// there is no previous.
-	} else {
-		struct ll_node *n;
-		for (n = l->head;
-		     n->next != l->selected && n->next != NULL;
-		     n = n->next) {
-		}
-		l->selected = n;
+		l->selected = l->selected->prev;
 	}
 
 	return l->selected == NULL ? NULL : l->selected->data;
@@ -358,6 +292,23 @@ void list_data_swap(struct list *list, void *a, void *b)
 	}
 	second = n;
 
+	if (list->intrusive) {
+		// The data must stay in its own node: move the nodes instead,
+		// and the selection with them to keep it on the same position.
+		struct ll_node *first_next = first->next;
+		struct ll_node *second_next = second->next;
+
+		node_unlink(list, second);
+		node_link_before(list, first, second);
+		if (first_next != second) {
+			node_unlink(list, first);
+			node_link_before(list, second_next, first);
+		}
+		if (list->selected == first || list->selected == second) {
+			list->selected = list->selected == first ? second : first;
+		}
+		return;
+	}
 
 	void *tmp = first->data;
 
@@ -376,7 +327,7 @@ void *list_data_handle_get(
 	struct list * const list,
 	unsigned int const position)
 {
-	if (position > list->size - 1) {
+	if (position >= (unsigned int) list->size) {
 		return NULL;
 	}
 
@@ -392,6 +343,33 @@ int list_size_get(const struct list *l)
 	return l->size;
 }
 
+void list_arena_init(struct list_arena *arena, struct ll_node *nodes, int capacity)
+{
+	arena->nodes = nodes;
+	arena->capacity = capacity;
+	arena->free = NULL;
+	for (int i = capacity - 1; i >= 0; i--) {
+		nodes[i].next = arena->free;
+		arena->free = &nodes[i];
+	}
+}
+
+const struct list_pool_stats *list_pool_stats_get(void)
+{
+	return &stats;
+}
+
+void list_pool_clear(void)
+{
+	assert(n_overflow == 0);
+	for (int i = 0; i < n_slabs; i++) {
+		free(slabs[i]);
+		stats.system_frees++;
+	}
+	n_slabs = 0;
+	pool_free = NULL;
+}
+
 // ----------------------------------------------------------------------------
 /// \brief Walk pos number of nodes from start. If the tail of a list is
 /// reached, go on from head (wrap around).
@@ -413,3 +391,144 @@ static struct ll_node *nodes_walker(struct ll_node *start, int pos)
 	}
 	return walker;
 }
+
+// Insert before at, or at the end if at is NULL.
+static struct ll_node *node_insert_before(
+	struct list *list,
+	struct ll_node *at,
+	void *data)
+{
+	struct ll_node *node;
+
+	if (list->intrusive) {
+		node = link_of(list, data);
+		assert(!node_is_linked(list, node));
+	} else {
+		node = node_alloc(list);
+	}
+	node->data = data;
+	node_link_before(list, at, node);
+	return node;
+}
+
+static void node_link_before(
+	struct list *list,
+	struct ll_node *at,
+	struct ll_node *node)
+{
+	node->prev = at != NULL ? at->prev : list->tail;
+	node->next = at;
+	if (node->prev != NULL) {
+		node->prev->next = node;
+	} else {
+		list->head = node;
+	}
+	if (at != NULL) {
+		at->prev = node;
+	} else {
+		list->tail = node;
+	}
+	list->size++;
+}
+
+static void node_unlink(struct list *list, struct ll_node *node)
+{
+	if (node->prev != NULL) {
+		node->prev->next = node->next;
+	} else {
+		list->head = node->next;
+	}
+	if (node->next != NULL) {
+		node->next->prev = node->prev;
+	} else {
+		list->tail = node->prev;
+	}
+	list->size--;
+}
+
+static struct ll_node *link_of(const struct list *list, const void *data)
+{
+	return (struct ll_node *) ((char *) data + list->link_offset);
+}
+
+// Cheap check, not a search: a node linked in another list passes, unless it
+// is that list's head.
+static bool node_is_linked(const struct list *list, const struct ll_node *node)
+{
+	return node->prev != NULL ? node->prev->next == node : list->head == node;
+}
+
+static struct ll_node *node_alloc(struct list *list)
+{
+	struct ll_node *node;
+
+	stats.nodes_allocated++;
+#if !defined(LIST_NODE_MALLOC)
+	if (list->arena != NULL && list->arena->free != NULL) {
+		node = list->arena->free;
+		list->arena->free = node->next;
+		return node;
+	}
+	if (pool_free == NULL && n_slabs < POOL_SLABS_MAX) {
+		struct ll_node *slab = malloc(POOL_SLAB_NODES * sizeof(*slab));
+
+		assert(slab);
+		stats.system_allocs++;
+		slabs[n_slabs++] = slab;
+		for (int i = POOL_SLAB_NODES - 1; i >= 0; i--) {
+			slab[i].next = pool_free;
+			pool_free = &slab[i];
+		}
+	}
+	if (pool_free != NULL) {
+		node = pool_free;
+		pool_free = node->next;
+		return node;
+	}
+	n_overflow++;
+#endif
+	node = malloc(sizeof(*node));
+	assert(node);
+	stats.system_allocs++;
+	return node;
+}
+
+static void node_free(struct list *list, struct ll_node *node)
+{
+	if (list->intrusive) {
+		// The link belongs to the element, only mark it unlinked.
+		node->prev = node->next = NULL;
+		return;
+	}
+#if !defined(LIST_NODE_MALLOC)
+	if (list->arena != NULL && arena_owns(list->arena, node)) {
+		node->next = list->arena->free;
+		list->arena->free = node;
+		return;
+	}
+	// Without overflow nodes alive, every node is from the slabs.
+	if (n_overflow == 0 || pool_owns(node)) {
+		node->next = pool_free;
+		pool_free = node;
+		return;
+	}
+	n_overflow--;
+#endif
+	free(node);
+	stats.system_frees++;
+}
+
+static bool arena_owns(const struct list_arena *arena, const struct ll_node *node)
+{
+	return node >= arena->nodes && node < arena->nodes + arena->capacity;
+}
+
+static bool pool_owns(const struct ll_node *node)
+{
+	for (int i = 0; i < n_slabs; i++) {
+		if (node >= slabs[i] && node < slabs[i] + POOL_SLAB_NODES) {
+			return true;
+		}
+	}
+	return false;
+}
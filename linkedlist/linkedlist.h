@@ -1,6 +1,7 @@
 #ifndef LINKEDLIST_H_INCLUDED
 #define LINKEDLIST_H_INCLUDED
 
+#include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
 
@@ -16,23 +17,173 @@ struct ll_node;
 // the c file.
 struct ll_node {
 	void *data;
+	struct ll_node *prev;
 	struct ll_node *next;
 };
 
+// Two backends implement this API, chosen at build time:
+// - linkedlist.c, the default: doubly linked nodes, with a tail pointer.
+//   Adding at either end, popping, stepping back and unlinking a known node
+//   are O(1).
+// - arraylist.c, with -DLIST_ARRAY: a growable vector of data pointers, and the
+//   index of the selected element. Walks are over contiguous memory, and
+//   positions are direct.
+// Users must only go through the functions below and the size member, the
+// other members differ between the backends.
+//
+// Linked nodes are taken from a pool shared by all lists, grown by slabs up to
+// LIST_MAX_SIZE nodes, and returned to it when unlinked: adding and removing
+// elements does not reach malloc() once the pool is warm. Past LIST_MAX_SIZE
+// live nodes, the extra ones are malloc()ed one by one. Building with
+// -DLIST_NODE_MALLOC disables the pool, every node is malloc()ed.
+//
+// A linked list may instead be intrusive, see LIST_INTRUSIVE(): each element
+// embeds the struct ll_node linking it, and adding or removing an element
+// allocates nothing. Finding the node of an element is O(1), so removing and
+// selecting by data are too. An element may only be in one list per embedded
+// node, and removing it from a list it is not in is undefined. The array
+// backend has no nodes, intrusive lists are plain lists there.
+//
+// A linked list may also get its own arena, storage provided by the caller, to
+// keep its nodes together in memory. Nodes come from the arena first, then from
+// the pool once it is full. An arena may be shared by several lists. The array
+// backend ignores arenas.
+struct list_arena {
+	struct ll_node *nodes;
+	int capacity;
+	struct ll_node *free; // Free nodes of the arena, linked through next
+};
+
+#if defined(LIST_ARRAY)
+struct list {
+	int size;
+	int capacity;
+	void **items;
+	// Position of the selected element plus one, 0 if none: a zeroed list
+	// is a valid empty list, like with the linked backend.
+	int selected_pos;
+	struct list_arena *arena; // Unused
+};
+
+#define LIST_INTRUSIVE(type, member) LIST_EMPTY
+
+#define LIST_EMPTY (struct list) {  \
+		.size = 0,                              \
+		.capacity = 0,                      \
+		.items = NULL,                      \
+		.selected_pos = 0,                  \
+		.arena = NULL                       \
+}
+#else
 struct list {
 	int size;
 	struct ll_node *head;
+	struct ll_node *tail;
 	// An ll_node* is maybe not very interesting, would pointer to the
 	// selected *data be more interesting? A pointer to the ll_node is
 	// nice, to add a new client to the list.
 	struct ll_node *selected;
+	struct list_arena *arena; // NULL to use the shared pool only
+	bool intrusive;
+	size_t link_offset; // Intrusive: offset of the node in the elements
 };
 
 #define LIST_EMPTY (struct list) {  \
 		.size = 0,                              \
 		.head = NULL,                       \
-		.selected = NULL                    \
+		.tail = NULL,                       \
+		.selected = NULL,                   \
+		.arena = NULL,                      \
+		.intrusive = false,                 \
+		.link_offset = 0                    \
+}
+
+//  ----------------------------------------------------------------------------
+/// \brief  An empty intrusive list, of elements of the given type linked by
+/// their struct ll_node member. Elements must start unlinked, zeroed.
+//  ----------------------------------------------------------------------------
+#define LIST_INTRUSIVE(type, member) (struct list) {  \
+		.size = 0,                              \
+		.head = NULL,                       \
+		.tail = NULL,                       \
+		.selected = NULL,                   \
+		.arena = NULL,                      \
+		.intrusive = true,                  \
+		.link_offset = offsetof(type, member) \
 }
+#endif
+
+// Iteration macros: plain loops, the compiler can inline and optimize the body
+// unlike a list_run_for_all() or list_find() callback. Prefer them on hot
+// paths. break and return work as in any loop.
+
+//  ----------------------------------------------------------------------------
+/// \brief  Walk the data of any list, in order. The loop variable is declared
+/// by the caller, of the type of the data. The list must not be modified during
+/// the walk.
+/// \param  var  Loop variable.
+/// \param  l  Pointer to the list.
+//  ----------------------------------------------------------------------------
+#if defined(LIST_ARRAY)
+#define LIST_FOR_EACH(var, l)                                           \
+	for (int var##_pos_ = 0;                                        \
+	     var##_pos_ < (l)->size                                     \
+	     && ((var) = (l)->items[var##_pos_], true);                 \
+	     var##_pos_++)
+#else
+#define LIST_FOR_EACH(var, l)                                           \
+	for (struct ll_node *var##_link_ = (l)->head;                   \
+	     var##_link_ != NULL && ((var) = var##_link_->data, true);  \
+	     var##_link_ = var##_link_->next)
+#endif
+
+//  ----------------------------------------------------------------------------
+/// \brief  Walk the elements of an intrusive list, in order. The loop variable
+/// must be declared by the caller as a pointer to type, the compiler checks
+/// it. The list must not be modified during the walk.
+/// \param  var  Loop variable.
+/// \param  l  Pointer to the list, as given to LIST_INTRUSIVE().
+/// \param  type  Type of the elements.
+/// \param  member  The struct ll_node member of type linking the elements.
+//  ----------------------------------------------------------------------------
+#if defined(LIST_ARRAY)
+#define LIST_FOR_EACH_ENTRY(var, l, type, member)                       \
+	for (int var##_pos_ = 0;                                        \
+	     var##_pos_ < (l)->size                                     \
+	     && ((var) = (type *) (l)->items[var##_pos_], true);       \
+	     var##_pos_++)
+#else
+#define LIST_ENTRY(node, type, member) \
+	((type *) ((char *) (node) - offsetof(type, member)))
+
+#define LIST_FOR_EACH_ENTRY(var, l, type, member)                       \
+	for (struct ll_node *var##_link_ = (assert((l)->intrusive), (l)->head); \
+	     var##_link_ != NULL                                        \
+	     && ((var) = LIST_ENTRY(var##_link_, type, member), true);  \
+	     var##_link_ = var##_link_->next)
+#endif
+
+struct list_pool_stats {
+	unsigned long nodes_allocated; // Nodes given to lists, from anywhere.
+	// malloc() calls, for slabs or nodes. With the array backend, realloc()
+	// calls growing a vector.
+	unsigned long system_allocs;
+	unsigned long system_frees;    // free() calls.
+};
+
+//  ----------------------------------------------------------------------------
+/// \brief  Give storage to an arena. The arena must outlive the lists using
+/// it, or they must be destroyed first.
+/// \param  nodes  Storage for capacity nodes.
+//  ----------------------------------------------------------------------------
+void list_arena_init(struct list_arena *arena, struct ll_node *nodes, int capacity);
+
+const struct list_pool_stats *list_pool_stats_get(void);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Free the pool slabs. All lists must be destroyed first.
+//  ----------------------------------------------------------------------------
+void list_pool_clear(void);
 
 //  ----------------------------------------------------------------------------
 /// \brief  Link a new element at the end of the destination list.
@@ -73,6 +224,34 @@ void list_rm(struct list *l, void *data);
 // ----------------------------------------------------------------------------
 void *list_pop(struct list *l);
 
+#if !defined(LIST_ARRAY)
+// Node handles, linked backend only. A handle stays valid until its node is
+// unlinked, by any function, or the list is destroyed. Callers keeping the
+// handle of an element can then unlink or select it without a search.
+
+//  ----------------------------------------------------------------------------
+/// \brief  Same as list_add(), returning the handle of the new node.
+//  ----------------------------------------------------------------------------
+struct ll_node *list_node_add(struct list *l, void *data);
+
+//  ----------------------------------------------------------------------------
+/// \return Handle of the first node holding data, NULL if none. For an
+/// intrusive list, data must be in l or in no list: a node linked in another
+/// list is only told apart if it is that list's head.
+//  ----------------------------------------------------------------------------
+struct ll_node *list_node_find(struct list *l, const void *data);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Unlink a node of the list, in O(1). The selection is cleared if the
+/// node was selected.
+/// \param  node  Handle of a node of l, invalid after the call.
+/// \return The data of the node.
+//  ----------------------------------------------------------------------------
+void *list_node_rm(struct list *l, struct ll_node *node);
+
+void list_node_select(struct list *l, struct ll_node *node);
+#endif
+
 // ----------------------------------------------------------------------------
 /// \brief Destroy the list passed as parameter. Only the list and its nodes are
 /// destroyed, the data pointed to by each node needs to be destroyed separately
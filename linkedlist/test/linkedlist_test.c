@@ -6,6 +6,8 @@
 #include <stddef.h>
 #include <stdio.h>
 #include <malloc.h>
+#include <string.h>
+#include <time.h>
 
 //******************************************************************************
 // Module macros
@@ -25,6 +27,28 @@
 //******************************************************************************
 // Module constants
 //******************************************************************************
+#define BENCH_N_OPS 1000000 // Remove and add operations per benchmark run
+#define BENCH_N_WALKS 100000 // Operations walking to the tail, per measure
+
+#define BENCH_ITEM_SIZE 400 // About the size of a struct Client
+
+#if defined(LIST_ARRAY)
+#define BACKEND "array"
+#elif defined(LIST_NODE_MALLOC)
+#define BACKEND "malloc"
+#else
+#define BACKEND "pool"
+#endif
+
+//******************************************************************************
+// Module types
+//******************************************************************************
+// Element of the intrusive lists.
+struct item {
+	int value;
+	struct ll_node link;
+	char pad[BENCH_ITEM_SIZE];
+};
 
 //******************************************************************************
 // Module variables
@@ -51,6 +75,7 @@ static bool int_arrays_equal(
 
 // Test functions.
 static void test_list_run_for_all(void);
+static void test_list_for_each(void);
 static void test_list_data_handle_get(void);
 static void test_list_add_before(void);
 static void test_list_add_before_selected(void);
@@ -58,13 +83,40 @@ static void test_list_rm(void);
 static void test_list_next_prev(void);
 static void test_list_pop(void);
 static void test_list_data_swap(void);
+static void test_list_node_handles(void);
+static void test_intrusive(void);
+static void test_pool_reuse(void);
+static void test_arena(void);
+
+// Benchmarks.
+static void bench_churn(int n_elements);
+static void bench_walks(int n_elements);
+static void bench_intrusive(int n_elements);
+static long nodes_sum(struct list *list);
+static long intrusive_sum(struct list *list);
+static bool is_same(void *data, void *storage);
+static double elapsed_ns(const struct timespec *start, const struct timespec *end);
 
 //******************************************************************************
 // Function definitions
 //******************************************************************************
-int main(void)
+int main(int argc, char *argv[])
 {
+	if (argc == 2 && strcmp(argv[1], "bench") == 0) {
+		bench_churn(10);
+		bench_churn(100);
+		bench_churn(1000);
+		bench_walks(10);
+		bench_walks(100);
+		bench_walks(1000);
+		bench_intrusive(10);
+		bench_intrusive(100);
+		bench_intrusive(1000);
+		return 0;
+	}
+
 	test_list_run_for_all();
+	test_list_for_each();
 	test_list_data_handle_get();
 	test_list_add_before();
 	test_list_add_before_selected();
@@ -72,6 +124,10 @@ int main(void)
 	test_list_next_prev();
 	test_list_pop();
 	test_list_data_swap();
+	test_list_node_handles();
+	test_intrusive();
+	test_pool_reuse();
+	test_arena();
 	printf("All tests passed.\n");
 }
 
@@ -90,10 +146,7 @@ static void test_list_run_for_all(void)
 		*data_objects[i] = data[i];
 	}
 
-	struct list list = {
-		.head = NULL,
-		.size = 0
-	};
+	struct list list = LIST_EMPTY;
 
 	populate(&list, data_objects, NB_ELEMENTS(data));
 
@@ -106,6 +159,44 @@ static void test_list_run_for_all(void)
 	TEST_END_PRINT();
 }
 
+static void test_list_for_each(void)
+{
+	TEST_START_PRINT();
+	int data[] = { 1, 2, 3, 4, 5 };
+	struct list list = LIST_EMPTY;
+	int *d;
+
+	LIST_FOR_EACH(d, &list) {
+		assert(false);
+	}
+	for (int i = 0; i < NB_ELEMENTS(data); i++) {
+		list_add(&list, &data[i]);
+	}
+
+	read_to_array_reset();
+	LIST_FOR_EACH(d, &list) {
+		read_to_array(d, NULL);
+	}
+	assert(int_arrays_equal(data, read_array, NB_ELEMENTS(data)));
+
+	// Nested walks, and break.
+	int n_pairs = 0;
+	LIST_FOR_EACH(d, &list) {
+		int *e;
+
+		LIST_FOR_EACH(e, &list) {
+			if (e == d) {
+				break;
+			}
+			n_pairs++;
+		}
+	}
+	assert(n_pairs == 10);
+
+	list_destroy(&list);
+	TEST_END_PRINT();
+}
+
 static void test_list_data_handle_get(void)
 {
 	TEST_START_PRINT();
@@ -119,10 +210,7 @@ static void test_list_data_handle_get(void)
 
 	unsigned int pos = 3;
 
-	struct list list = {
-		.head = NULL,
-		.size = 0
-	};
+	struct list list = LIST_EMPTY;
 
 	populate(&list, data_objects, NB_ELEMENTS(data));
 
@@ -163,10 +251,7 @@ static void test_list_add_before(void)
 		*data_objects[i] = data[i];
 	}
 
-	struct list list = {
-		.head = NULL,
-		.size = 0
-	};
+	struct list list = LIST_EMPTY;
 	populate(&list, data_objects, NB_ELEMENTS(data));
 
 	int extra_data = 42;
@@ -180,6 +265,14 @@ static void test_list_add_before(void)
 
 	assert(int_arrays_equal((int[]) { 1, 2, 42, 3, 4, 5 }, read_array, NB_ELEMENTS(data) + 1));
 
+	int extra_data_at_head = 7;
+
+	list_add_before(&list, data_objects[0], &extra_data_at_head);
+
+	read_to_array_reset();
+	list_run_for_all(&list, read_to_array, NULL);
+	assert(int_arrays_equal((int[]) { 7, 1, 2, 42, 3, 4, 5 }, read_array, NB_ELEMENTS(data) + 2));
+
 	list_destroy(&list);
 	TEST_END_PRINT();
 }
@@ -234,10 +327,7 @@ static void test_list_rm(void)
 		*data_objects[i] = data[i];
 	}
 
-	struct list list = {
-		.head = NULL,
-		.size = 0
-	};
+	struct list list = LIST_EMPTY;
 	populate(&list, data_objects, NB_ELEMENTS(data));
 
 	// Remove first
@@ -269,8 +359,8 @@ static void test_list_rm(void)
 	list_rm(&list, data_objects[1]);
 	list_rm(&list, data_objects[3]);
 	assert(list_size_get(&list) == 0);
-	assert(list.head == NULL);
-	assert(list.selected == NULL);
+	assert(list_data_handle_get(&list, 0) == NULL);
+	assert(list_selected_data_get(&list) == NULL);
 
 	TEST_END_PRINT();
 }
@@ -377,7 +467,19 @@ static void test_list_pop(void)
 	popped = list_pop(&list);
 	assert(*popped == 1);
 	assert(list.size == 0);
-	assert(list.head == NULL);
+	assert(list_data_handle_get(&list, 0) == NULL);
+	assert(list_pop(&list) == NULL);
+
+	// The emptied list is usable at both ends again.
+	list_prepend(&list, &data[1]);
+	list_add(&list, &data[2]);
+	list_prepend(&list, &data[0]);
+	assert(list_tail_select(&list) == &data[2]);
+	assert(list_prev_select(&list) == &data[1]);
+	assert(list_prev_select(&list) == &data[0]);
+	assert(list_prev_select(&list) == &data[0]);
+	assert(list_pop(&list) == &data[2]);
+	assert(list_tail_select(&list) == &data[1]);
 
 	list_destroy(&list);
 
@@ -422,6 +524,392 @@ static void test_list_data_swap(void)
 	TEST_END_PRINT();
 }
 
+static void test_list_node_handles(void)
+{
+	TEST_START_PRINT();
+#if !defined(LIST_ARRAY)
+	int data[] = { 1, 2, 3, 4 };
+	struct ll_node *nodes[NB_ELEMENTS(data)];
+	struct list list = LIST_EMPTY;
+
+	for (int i = 0; i < NB_ELEMENTS(data); i++) {
+		nodes[i] = list_node_add(&list, &data[i]);
+		assert(nodes[i]->data == &data[i]);
+	}
+	assert(list.tail == nodes[3]);
+	assert(list_node_find(&list, &data[2]) == nodes[2]);
+	assert(list_node_find(&list, &list) == NULL);
+
+	// Unlinking the selected node clears the selection.
+	list_node_select(&list, nodes[1]);
+	assert(list_selected_data_get(&list) == &data[1]);
+	assert(list_node_rm(&list, nodes[1]) == &data[1]);
+	assert(list_selected_data_get(&list) == NULL);
+	assert(nodes[0]->next == nodes[2] && nodes[2]->prev == nodes[0]);
+
+	// Both ends.
+	assert(list_node_rm(&list, nodes[0]) == &data[0]);
+	assert(list.head == nodes[2] && nodes[2]->prev == NULL);
+	assert(list_node_rm(&list, nodes[3]) == &data[3]);
+	assert(list.tail == nodes[2] && nodes[2]->next == NULL);
+	assert(list.size == 1);
+	assert(list_node_rm(&list, nodes[2]) == &data[2]);
+	assert(list.head == NULL && list.tail == NULL && list.size == 0);
+
+	list_destroy(&list);
+#endif
+	TEST_END_PRINT();
+}
+
+static void test_intrusive(void)
+{
+	TEST_START_PRINT();
+	struct item items[5] = { 0 };
+	struct list list = LIST_INTRUSIVE(struct item, link);
+	unsigned long allocated = list_pool_stats_get()->nodes_allocated;
+	struct item *it;
+	int i;
+
+	for (i = 0; i < NB_ELEMENTS(items); i++) {
+		items[i].value = i + 1;
+	}
+	list_add(&list, &items[1]);
+	list_add(&list, &items[3]);
+	list_prepend(&list, &items[0]);
+	list_add_before(&list, &items[3], &items[2]);
+	list_add_before(&list, &list, &items[4]); // Not found, appended
+
+	i = 0;
+	LIST_FOR_EACH_ENTRY(it, &list, struct item, link) {
+		assert(it == &items[i]);
+		i++;
+	}
+	assert(i == NB_ELEMENTS(items));
+#if !defined(LIST_ARRAY)
+	assert(list_pool_stats_get()->nodes_allocated == allocated);
+#endif
+
+	// Swapping moves the elements, the selection stays on its position.
+	list_select(&list, &items[1]);
+	list_data_swap(&list, &items[1], &items[3]);
+	list_data_swap(&list, &items[0], &items[2]);
+	read_to_array_reset();
+	LIST_FOR_EACH_ENTRY(it, &list, struct item, link) {
+		read_to_array(&it->value, NULL);
+	}
+	assert(int_arrays_equal((int[]) { 3, 4, 1, 2, 5 }, read_array, 5));
+	assert(list_selected_data_get(&list) == &items[3]);
+
+	list_rm(&list, &items[3]);
+	assert(list_selected_data_get(&list) == NULL);
+	list_rm(&list, &items[3]); // No longer in the list
+	assert(list.size == 4);
+	assert(list_pop(&list) == &items[4]);
+	assert(list_data_handle_get(&list, 0) == &items[2]);
+	assert(list_tail_select(&list) == &items[1]);
+	assert(list_prev_select(&list) == &items[0]);
+
+	// Destroying unlinks, the elements can go in a list again.
+	list_destroy(&list);
+	assert(list.size == 0);
+	list_add(&list, &items[4]);
+	list_add(&list, &items[0]);
+	assert(list_data_handle_get(&list, 1) == &items[0]);
+#if !defined(LIST_ARRAY)
+	assert(list_pool_stats_get()->nodes_allocated == allocated);
+#else
+	(void) allocated;
+#endif
+	list_destroy(&list);
+
+	TEST_END_PRINT();
+}
+
+static void test_pool_reuse(void)
+{
+	TEST_START_PRINT();
+	int data[200];
+	struct list list = LIST_EMPTY;
+
+	for (int i = 0; i < NB_ELEMENTS(data); i++) {
+		data[i] = i;
+		list_add(&list, &data[i]);
+	}
+	unsigned long allocs = list_pool_stats_get()->system_allocs;
+
+	// Churning a list that does not grow reuses its freed nodes.
+	for (int round = 0; round < 10; round++) {
+		for (int i = 0; i < NB_ELEMENTS(data); i++) {
+			list_rm(&list, &data[i]);
+			list_add(&list, &data[i]);
+		}
+	}
+	assert(list.size == NB_ELEMENTS(data));
+#if defined(LIST_NODE_MALLOC) && !defined(LIST_ARRAY)
+	assert(list_pool_stats_get()->system_allocs == allocs + 10 * NB_ELEMENTS(data));
+#else
+	assert(list_pool_stats_get()->system_allocs == allocs);
+#endif
+	list_destroy(&list);
+	list_add(&list, &data[7]);
+	assert(*(int *) list_pop(&list) == 7);
+	assert(list_data_handle_get(&list, 0) == NULL);
+
+	list_pool_clear();
+	TEST_END_PRINT();
+}
+
+static void test_arena(void)
+{
+	TEST_START_PRINT();
+	int data[] = { 1, 2, 3, 4, 5, 6 };
+	struct ll_node nodes[4];
+	struct list_arena arena;
+	struct list list = LIST_EMPTY;
+
+	list_arena_init(&arena, nodes, NB_ELEMENTS(nodes));
+	list.arena = &arena;
+
+	// Past the arena capacity, nodes come from the pool.
+	for (int i = 0; i < NB_ELEMENTS(data); i++) {
+		list_add(&list, &data[i]);
+	}
+	read_to_array_reset();
+	list_run_for_all(&list, read_to_array, NULL);
+	assert(int_arrays_equal(data, read_array, NB_ELEMENTS(data)));
+#if !defined(LIST_NODE_MALLOC) && !defined(LIST_ARRAY)
+	assert(arena.free == NULL);
+	assert(list.head >= nodes && list.head < nodes + NB_ELEMENTS(nodes));
+#endif
+
+	// A freed arena node goes back to the arena, and is used next.
+	list_rm(&list, &data[0]);
+#if !defined(LIST_NODE_MALLOC) && !defined(LIST_ARRAY)
+	assert(arena.free == &nodes[0]);
+#endif
+	list_prepend(&list, &data[0]);
+	read_to_array_reset();
+	list_run_for_all(&list, read_to_array, NULL);
+	assert(int_arrays_equal(data, read_array, NB_ELEMENTS(data)));
+
+	list_destroy(&list);
+#if !defined(LIST_NODE_MALLOC) && !defined(LIST_ARRAY)
+	for (int i = 0; i < NB_ELEMENTS(nodes); i++) {
+		assert(arena.free != NULL);
+		arena.free = arena.free->next;
+	}
+	assert(arena.free == NULL);
+#endif
+
+	list_pool_clear();
+	TEST_END_PRINT();
+}
+
+//------------------------------------------------------------------------------
+// Benchmarks
+//------------------------------------------------------------------------------
+
+//  ----------------------------------------------------------------------------
+/// \brief  Remove the head of a list and add it back at the end, the node
+/// churn of sending clients between tagviews. The bench target of the makefile
+/// runs it for each backend: -DLIST_NODE_MALLOC for the malloc() path,
+/// -DLIST_ARRAY for the array backend.
+//  ----------------------------------------------------------------------------
+static void bench_churn(int n_elements)
+{
+	int *data = malloc(n_elements * sizeof(*data));
+	struct list list = LIST_EMPTY;
+	struct timespec start, end;
+	unsigned long allocs, frees;
+
+	for (int i = 0; i < n_elements; i++) {
+		list_add(&list, &data[i]);
+	}
+	allocs = list_pool_stats_get()->system_allocs;
+	frees = list_pool_stats_get()->system_frees;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < BENCH_N_OPS; i++) {
+		void *d = list_data_handle_get(&list, 0);
+
+		list_rm(&list, d);
+		list_add(&list, d);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	printf("%-6s %4d elements: rm+add %7.1f ns/op, %lu mallocs, %lu frees\n",
+	       BACKEND,
+	       n_elements,
+	       elapsed_ns(&start, &end) / BENCH_N_OPS,
+	       list_pool_stats_get()->system_allocs - allocs,
+	       list_pool_stats_get()->system_frees - frees);
+
+	list_destroy(&list);
+	list_pool_clear();
+	free(data);
+}
+
+//  ----------------------------------------------------------------------------
+/// \brief  The operations reaching the tail: finding the last element, getting
+/// it by position, selecting it, and popping it.
+//  ----------------------------------------------------------------------------
+static void bench_walks(int n_elements)
+{
+	int *data = malloc(n_elements * sizeof(*data));
+	struct list list = LIST_EMPTY;
+	struct timespec start, end;
+	volatile void *sink;
+	double find_ns, get_ns, tail_ns, pop_ns;
+
+	for (int i = 0; i < n_elements; i++) {
+		list_add(&list, &data[i]);
+	}
+	void *last = &data[n_elements - 1];
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < BENCH_N_WALKS; i++) {
+		sink = list_find(&list, is_same, last);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	find_ns = elapsed_ns(&start, &end) / BENCH_N_WALKS;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < BENCH_N_WALKS; i++) {
+		sink = list_data_handle_get(&list, n_elements - 1);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	get_ns = elapsed_ns(&start, &end) / BENCH_N_WALKS;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < BENCH_N_WALKS; i++) {
+		sink = list_tail_select(&list);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	tail_ns = elapsed_ns(&start, &end) / BENCH_N_WALKS;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < BENCH_N_WALKS; i++) {
+		list_add(&list, list_pop(&list));
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	pop_ns = elapsed_ns(&start, &end) / BENCH_N_WALKS;
+	(void) sink;
+
+	printf("%-6s %4d elements: find %7.1f, get %7.1f, tail_select %7.1f, "
+	       "pop+add %7.1f ns/op\n",
+	       BACKEND, n_elements, find_ns, get_ns, tail_ns, pop_ns);
+
+	list_destroy(&list);
+	list_pool_clear();
+	free(data);
+}
+
+//  ----------------------------------------------------------------------------
+/// \brief  The same elements, client sized and allocated one by one, in a list
+/// of nodes and in an intrusive list: walking the list to read each element,
+/// as the layouts do, and removing and adding back an element.
+//  ----------------------------------------------------------------------------
+static void bench_intrusive(int n_elements)
+{
+	struct item **items = malloc(n_elements * sizeof(*items));
+	struct list nodes = LIST_EMPTY;
+	struct list intrusive = LIST_INTRUSIVE(struct item, link);
+	struct timespec start, end;
+	volatile long sink;
+	double walk_ns[2], churn_ns[2];
+	struct list *lists[2] = { &nodes, &intrusive };
+	unsigned int seed = 1;
+
+	for (int i = 0; i < n_elements; i++) {
+		items[i] = calloc(1, sizeof(*items[i]));
+		items[i]->value = i;
+	}
+	// Shuffled, the list order is not the memory order.
+	for (int i = n_elements - 1; i > 0; i--) {
+		seed = seed * 1103515245 + 12345;
+		int j = (seed >> 16) % (i + 1);
+		struct item *tmp = items[i];
+
+		items[i] = items[j];
+		items[j] = tmp;
+	}
+	for (int i = 0; i < n_elements; i++) {
+		list_add(&nodes, items[i]);
+		list_add(&intrusive, items[i]);
+	}
+
+	for (int l = 0; l < 2; l++) {
+		int n_walks = BENCH_N_OPS / n_elements;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int i = 0; i < n_walks; i++) {
+			sink = l == 0 ? nodes_sum(lists[l]) : intrusive_sum(lists[l]);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		walk_ns[l] = elapsed_ns(&start, &end) / n_walks / n_elements;
+
+		clock_gettime(CLOCK_MONOTONIC, &start);
+		for (int i = 0; i < BENCH_N_OPS; i++) {
+			void *d = list_data_handle_get(lists[l], 0);
+
+			list_rm(lists[l], d);
+			list_add(lists[l], d);
+		}
+		clock_gettime(CLOCK_MONOTONIC, &end);
+		churn_ns[l] = elapsed_ns(&start, &end) / BENCH_N_OPS;
+	}
+	(void) sink;
+
+	printf("%-6s %4d elements: walk nodes %5.1f, intrusive %5.1f ns/element; "
+	       "rm+add nodes %5.1f, intrusive %5.1f ns/op\n",
+	       BACKEND, n_elements, walk_ns[0], walk_ns[1], churn_ns[0], churn_ns[1]);
+
+	list_destroy(&nodes);
+	list_destroy(&intrusive);
+	list_pool_clear();
+	for (int i = 0; i < n_elements; i++) {
+		free(items[i]);
+	}
+	free(items);
+}
+
+static long nodes_sum(struct list *list)
+{
+	long sum = 0;
+
+#if defined(LIST_ARRAY)
+	for (int i = 0; i < list->size; i++) {
+		sum += ((struct item *) list->items[i])->value;
+	}
+#else
+	for (struct ll_node *n = list->head; n != NULL; n = n->next) {
+		sum += ((struct item *) n->data)->value;
+	}
+#endif
+	return sum;
+}
+
+static long intrusive_sum(struct list *list)
+{
+	struct item *it;
+	long sum = 0;
+
+	LIST_FOR_EACH_ENTRY(it, list, struct item, link) {
+		sum += it->value;
+	}
+	return sum;
+}
+
+static bool is_same(void *data, void *storage)
+{
+	return data == storage;
+}
+
+static double elapsed_ns(const struct timespec *start, const struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
 //------------------------------------------------------------------------------
 // Helper functions
 //------------------------------------------------------------------------------
@@ -5,6 +5,7 @@
 #include "drw.h"
 #include "dwm.h"
 #include "client.h"
+#include "clientlist.h"
 #include "config.h"
 #include "monitor.h"
 #include "util.h"
@@ -36,7 +37,7 @@ struct Client *mon_selected_client_get(const struct Monitor *m)
 
 void mon_selected_client_set(struct Monitor *m, struct Client *c)
 {
-	list_select(&m->tagview->clients, c);
+	tagview_selected_client_set(m->tagview, c);
 }
 
 void mon_tag_switch(struct Monitor *m, struct tagview *tagview)
@@ -57,28 +58,73 @@ int area_in_mon(int x, int y, int w, int h, const Monitor *m)
 		     MIN(y + h, m->wy + m->wh) - MAX(y, m->wy));
 }
 
-void
-mon_arrange(Monitor *m)
+void mon_arrange_schedule(struct Monitor *m)
 {
 	P_DEBUG("%s: %p\n", __func__, (void *) m);
 	if (m) {
-		tagview_arrange(m);
-		restack(m);
+		m->dirty |= MON_DIRTY_LAYOUT | MON_DIRTY_STACK | MON_DIRTY_BAR;
 	} else {
 		P_DEBUG("%s with argument NULL\n", __func__);
 	}
 }
 
-void mon_arrange_cb(void *monitor, void *storage)
+void mon_restack_schedule(struct Monitor *m)
 {
-	mon_arrange((struct Monitor *) monitor);
+	if (m) {
+		m->dirty |= MON_DIRTY_STACK | MON_DIRTY_BAR;
+	}
 }
 
-bool mon_has_client(void *monitor, void *client)
+void mon_bar_schedule(struct Monitor *m)
 {
-	struct Monitor *m = (struct Monitor *) monitor;
+	if (m) {
+		m->dirty |= MON_DIRTY_BAR;
+	}
+}
+
+void mon_flush(struct Monitor *m)
+{
+	unsigned int dirty = m->dirty;
+
+	if (dirty == 0) {
+		return;
+	}
+	P_DEBUG("%s: %p, dirty 0x%x\n", __func__, (void *) m, dirty);
+
+	// Cleared first: arranging may schedule again, for the next flush.
+	m->dirty = 0;
+	if (dirty & MON_DIRTY_LAYOUT) {
+		tagview_arrange(m);
+	}
+	if (dirty & MON_DIRTY_STACK) {
+		restack(m); // Draws the bar
+	} else if (dirty & MON_DIRTY_BAR) {
+		bar_draw(m);
+	}
+}
+
+void mon_flush_all(struct list *mons)
+{
+	struct Monitor *m;
+
+	LIST_FOR_EACH(m, mons) {
+		mon_flush(m);
+	}
+}
+
+void mon_arrange_schedule_cb(void *monitor, void *storage)
+{
+	mon_arrange_schedule((struct Monitor *) monitor);
+}
 
-	return tagview_has_client(m->tagview, (struct Client *) client);
+void mon_bar_schedule_cb(void *monitor, void *storage)
+{
+	mon_bar_schedule((struct Monitor *) monitor);
+}
+
+bool mon_has_client(void *monitor, void *client)
+{
+	return client_mon_get((struct Client *) client) == monitor;
 }
 
 bool mon_has_window(void *monitor, void *window)
@@ -97,11 +143,8 @@ bool mon_shows_tagview(void *monitor, void *tagview)
 }
 
 static void
-configure_client_w_changes(void *client, void *storage)
+configure_client_w_changes(struct Client *c, XWindowChanges *win_changes)
 {
-	struct Client *c = (struct Client *) client;
-	XWindowChanges *win_changes = (XWindowChanges *) storage;
-
 	if (c->isfloating) {
 		return;
 	}
@@ -111,6 +154,7 @@ configure_client_w_changes(void *client, void *storage)
 		c->win,
 		CWSibling | CWStackMode,
 		win_changes);
+	clientlist_stack_below(c->win, win_changes->sibling);
 
 	win_changes->sibling = c->win;
 }
@@ -122,8 +166,9 @@ configure_client_w_changes(void *client, void *storage)
 void
 restack(struct Monitor *m)
 {
-	Client *c;
+	Client *c, *tiled;
 	XEvent ev;
+	bool raise;
 
 	P_DEBUG("%s(%p)\n", __func__, (void *) m);
 
@@ -131,7 +176,8 @@ restack(struct Monitor *m)
 	c = tagview_selected_client_get(m->tagview);
 	if (c == NULL)
 		return;
-	if (c->isfloating || (m->tagview->arrange == NULL)) {
+	raise = c->isfloating || (m->tagview->arrange == NULL);
+	if (raise) {
 		/// Should raise tiled windows as well, for the sake
 		/// of painting shadows?
 		XRaiseWindow(dpy, c->win);
@@ -140,10 +186,14 @@ restack(struct Monitor *m)
 		XWindowChanges win_changes;
 		win_changes.stack_mode = Below;
 		win_changes.sibling = m->barwin;
-		list_run_for_all(
-			&m->tagview->clients,
-			configure_client_w_changes,
-			&win_changes);
+		TAGVIEW_FOR_EACH_CLIENT(tiled, m->tagview) {
+			configure_client_w_changes(tiled, &win_changes);
+		}
+	}
+	// The tiled windows went below the bar, still under the raised one:
+	// recorded last, as the mirror places them above all managed windows.
+	if (raise) {
+		clientlist_raise(c->win);
 	}
 	XSync(dpy, False);
 	while (XCheckMaskEvent(dpy, EnterWindowMask, &ev));
@@ -156,8 +206,6 @@ createmon(struct tagview *with_tagview, int x, int y, int w, int h)
 
 	m = ecalloc(1, sizeof(Monitor));
 
-	// Not supporting bars yet, so window area is the same as
-	// monitor area
 	m->wx = m->mx = x;
 	m->wy = m->my = y;
 	m->ww = m->mw = w;
@@ -165,16 +213,24 @@ createmon(struct tagview *with_tagview, int x, int y, int w, int h)
 
 	m->showbar = showbar;
 	m->topbar = topbar;
+	updatebarpos(m);
 	m->tagview = with_tagview;
+	if (with_tagview != NULL) {
+		with_tagview->mon = m;
+	}
 	return m;
 }
 
 void monitor_destruct(struct Monitor *m)
 {
 #if BAR
-	XUnmapWindow(dpy, mon->barwin);
-	XDestroyWindow(dpy, mon->barwin);
+	XUnmapWindow(dpy, m->barwin);
+	XDestroyWindow(dpy, m->barwin);
 #endif
+	bar_mon_free(m);
+	if (m->tagview != NULL && m->tagview->mon == m) {
+		m->tagview->mon = NULL;
+	}
 	free(m);
 }
 
@@ -10,6 +10,13 @@ typedef struct Monitor Monitor;
 #include "tagview.h"
 #include "util.h"
 
+// Work pending on a monitor, done by mon_flush().
+enum mon_dirty {
+	MON_DIRTY_LAYOUT = 1 << 0,
+	MON_DIRTY_STACK = 1 << 1,
+	MON_DIRTY_BAR = 1 << 2
+};
+
 struct Monitor {
 	char ltsymbol[16];  // TODO: move to tagview
 	float mfact;        // TODO: move to tagview
@@ -30,6 +37,8 @@ struct Monitor {
 	//Client       *stack;
 	//Monitor      *next;
 	Window barwin;
+	struct bar_state *bar; // Owned by the bar backend
+	unsigned int dirty; // enum mon_dirty bits
 };
 
 int mon_n_clients_get(const struct Monitor *m);
@@ -38,13 +47,41 @@ struct Client *mon_selected_client_get(const struct Monitor *m);
 void mon_selected_client_set(struct Monitor *m, struct Client *c);
 
 void mon_tag_switch(struct Monitor *m, struct tagview *tagview);
-void mon_arrange(Monitor *m);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Schedule arranging, restacking and drawing the bar of a monitor.
+/// Nothing is done until mon_flush(), so a monitor scheduled many times while
+/// handling events is arranged only once. Does nothing if m is NULL.
+//  ----------------------------------------------------------------------------
+void mon_arrange_schedule(struct Monitor *m);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Schedule restacking and drawing the bar of a monitor.
+//  ----------------------------------------------------------------------------
+void mon_restack_schedule(struct Monitor *m);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Schedule drawing the bar of a monitor.
+//  ----------------------------------------------------------------------------
+void mon_bar_schedule(struct Monitor *m);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Do the work scheduled on a monitor: arrange, then restack, then draw
+/// the bar, each only if scheduled.
+//  ----------------------------------------------------------------------------
+void mon_flush(struct Monitor *m);
+
+//  ----------------------------------------------------------------------------
+/// \brief  mon_flush() all monitors of the list.
+//  ----------------------------------------------------------------------------
+void mon_flush_all(struct list *mons);
 
 /* Callbacks for lists */
 bool mon_has_client(void *monitor, void *client);
 bool mon_has_window(void *monitor, void *window);
 bool mon_shows_tagview(void *monitor, void *tagview);
-void mon_arrange_cb(void *monitor, void *storage);
+void mon_arrange_schedule_cb(void *monitor, void *storage);
+void mon_bar_schedule_cb(void *monitor, void *storage);
 
 
 int area_in_mon(int x, int y, int w, int h, const Monitor *m);
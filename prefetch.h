@@ -0,0 +1,90 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include <stdbool.h>
+#include <sys/types.h>
+#include <xcb/xcb.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+
+// Prefetching of the window properties a client needs when it gets managed.
+// All property requests for a window are sent at once, on the XCB connection
+// underlying the Xlib display, and the replies are collected together: one
+// round trip instead of one per property.
+
+enum prefetch_prop {
+	PREFETCH_NET_WM_NAME,
+	PREFETCH_WM_NAME,
+	PREFETCH_TRANSIENT_FOR,
+	PREFETCH_NET_WM_STATE,
+	PREFETCH_NET_WM_WINDOW_TYPE,
+	PREFETCH_WM_NORMAL_HINTS,
+	PREFETCH_WM_HINTS,
+	PREFETCH_WM_PROTOCOLS,
+	PREFETCH_NET_WM_PID,
+	PREFETCH_LAST // Must be last
+};
+
+// Requests in flight for one window.
+struct prefetch {
+	Window win;
+	xcb_get_property_cookie_t cookies[PREFETCH_LAST];
+};
+
+// The collected properties, in the form the client module uses.
+struct client_props {
+	char name[256];         // Empty if the window has no name.
+	Window transient_for;   // None if not transient.
+	Atom state;             // First atom of _NET_WM_STATE, or None.
+	Atom window_type;       // First atom of _NET_WM_WINDOW_TYPE, or None.
+	bool has_size_hints;
+	XSizeHints size_hints;
+	bool has_wm_hints;
+	XWMHints wm_hints;
+	unsigned int protocols; // Bit (1 << i) set if wmatom[i] is supported.
+	pid_t pid;              // _NET_WM_PID, 0 if not set.
+};
+
+//  ----------------------------------------------------------------------------
+/// \brief  Send the property requests for a window, without waiting for the
+/// replies. Requests for many windows may be sent before collecting any.
+//  ----------------------------------------------------------------------------
+void prefetch_send(struct prefetch *p, Window w);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Wait for the replies of a prefetch_send(), and decode them. Missing
+/// properties, or a window that no longer exists, give empty values.
+//  ----------------------------------------------------------------------------
+void prefetch_collect(struct prefetch *p, struct client_props *props);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Send and collect, for a single window.
+//  ----------------------------------------------------------------------------
+void client_props_get(Window w, struct client_props *props);
+
+// Requests in flight to decide whether an existing window should be managed,
+// see scan().
+struct prefetch_state {
+	Window win;
+	xcb_get_window_attributes_cookie_t attributes;
+	xcb_get_geometry_cookie_t geometry;
+	xcb_get_property_cookie_t transient_for;
+	xcb_get_property_cookie_t wm_state;
+};
+
+struct window_state {
+	XWindowAttributes wa; // Only the fields client_create() uses are set.
+	bool is_transient;
+	long wm_state;        // -1 if the window has no WM_STATE.
+};
+
+void prefetch_state_send(struct prefetch_state *p, Window w);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Wait for the replies of a prefetch_state_send().
+/// \return False if the window attributes could not be read, e.g. the window
+/// is already destroyed.
+//  ----------------------------------------------------------------------------
+bool prefetch_state_collect(struct prefetch_state *p, struct window_state *s);
+
+#endif
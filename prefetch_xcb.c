@@ -0,0 +1,312 @@
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <xcb/xcb.h>
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xlib-xcb.h>
+#include <X11/Xutil.h>
+
+#include "prefetch.h"
+
+#include "dm.h"
+#include "dwm.h"
+#include "util.h"
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+// Number of 32 bit units to request for each property.
+#define TEXT_LENGTH (256 / 4)
+#define SIZE_HINTS_LENGTH 18 // Elements of xPropSizeHints
+#define SIZE_HINTS_OLD_LENGTH 15 // Before ICCCM version 1
+#define WM_HINTS_LENGTH 9 // Elements of xPropWMHints
+#define PROTOCOLS_LENGTH 32
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static xcb_connection_t *xcb_get(void);
+static xcb_get_property_cookie_t property_request(
+	Window w,
+	Atom property,
+	Atom type,
+	uint32_t length);
+static int text_decode(xcb_get_property_reply_t *r, char *text, unsigned int size);
+static Atom first_atom(xcb_get_property_reply_t *r);
+static bool size_hints_decode(xcb_get_property_reply_t *r, XSizeHints *h);
+static bool wm_hints_decode(xcb_get_property_reply_t *r, XWMHints *h);
+static unsigned int protocols_decode(xcb_get_property_reply_t *r);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+void prefetch_send(struct prefetch *p, Window w)
+{
+	p->win = w;
+	p->cookies[PREFETCH_NET_WM_NAME] = property_request(
+		w, netatom[NetWMName], XCB_GET_PROPERTY_TYPE_ANY, TEXT_LENGTH);
+	p->cookies[PREFETCH_WM_NAME] = property_request(
+		w, XA_WM_NAME, XCB_GET_PROPERTY_TYPE_ANY, TEXT_LENGTH);
+	p->cookies[PREFETCH_TRANSIENT_FOR] = property_request(
+		w, XA_WM_TRANSIENT_FOR, XA_WINDOW, 1);
+	p->cookies[PREFETCH_NET_WM_STATE] = property_request(
+		w, netatom[NetWMState], XA_ATOM, 1);
+	p->cookies[PREFETCH_NET_WM_WINDOW_TYPE] = property_request(
+		w, netatom[NetWMWindowType], XA_ATOM, 1);
+	p->cookies[PREFETCH_WM_NORMAL_HINTS] = property_request(
+		w, XA_WM_NORMAL_HINTS, XA_WM_SIZE_HINTS, SIZE_HINTS_LENGTH);
+	p->cookies[PREFETCH_WM_HINTS] = property_request(
+		w, XA_WM_HINTS, XA_WM_HINTS, WM_HINTS_LENGTH);
+	p->cookies[PREFETCH_WM_PROTOCOLS] = property_request(
+		w, wmatom[WMProtocols], XA_ATOM, PROTOCOLS_LENGTH);
+	p->cookies[PREFETCH_NET_WM_PID] = property_request(
+		w, netatom[NetWMPid], XA_CARDINAL, 1);
+}
+
+void prefetch_collect(struct prefetch *p, struct client_props *props)
+{
+	xcb_get_property_reply_t *r[PREFETCH_LAST];
+
+	// A reply is NULL if the request failed, e.g. the window is already
+	// destroyed. The error is discarded, like xerror() would do.
+	for (int i = 0; i < PREFETCH_LAST; i++) {
+		r[i] = xcb_get_property_reply(xcb_get(), p->cookies[i], NULL);
+	}
+
+	memset(props, 0, sizeof(*props));
+	if (!text_decode(r[PREFETCH_NET_WM_NAME], props->name, sizeof(props->name)))
+		text_decode(r[PREFETCH_WM_NAME], props->name, sizeof(props->name));
+
+	if (r[PREFETCH_TRANSIENT_FOR]
+	    && r[PREFETCH_TRANSIENT_FOR]->type == XA_WINDOW
+	    && xcb_get_property_value_length(r[PREFETCH_TRANSIENT_FOR]) >= 4) {
+		props->transient_for =
+			*(uint32_t *) xcb_get_property_value(r[PREFETCH_TRANSIENT_FOR]);
+	}
+
+	props->state = first_atom(r[PREFETCH_NET_WM_STATE]);
+	props->window_type = first_atom(r[PREFETCH_NET_WM_WINDOW_TYPE]);
+	props->has_size_hints = size_hints_decode(
+		r[PREFETCH_WM_NORMAL_HINTS],
+		&props->size_hints);
+	props->has_wm_hints = wm_hints_decode(
+		r[PREFETCH_WM_HINTS],
+		&props->wm_hints);
+	props->protocols = protocols_decode(r[PREFETCH_WM_PROTOCOLS]);
+	if (r[PREFETCH_NET_WM_PID]
+	    && r[PREFETCH_NET_WM_PID]->type == XA_CARDINAL
+	    && xcb_get_property_value_length(r[PREFETCH_NET_WM_PID]) >= 4) {
+		props->pid = *(uint32_t *) xcb_get_property_value(r[PREFETCH_NET_WM_PID]);
+	}
+
+	for (int i = 0; i < PREFETCH_LAST; i++) {
+		free(r[i]);
+	}
+}
+
+void client_props_get(Window w, struct client_props *props)
+{
+	struct prefetch p;
+
+	prefetch_send(&p, w);
+	prefetch_collect(&p, props);
+}
+
+void prefetch_state_send(struct prefetch_state *p, Window w)
+{
+	p->win = w;
+	p->attributes = xcb_get_window_attributes(xcb_get(), w);
+	p->geometry = xcb_get_geometry(xcb_get(), w);
+	p->transient_for = property_request(w, XA_WM_TRANSIENT_FOR, XA_WINDOW, 1);
+	p->wm_state = property_request(w, wmatom[WMState], wmatom[WMState], 2);
+}
+
+bool prefetch_state_collect(struct prefetch_state *p, struct window_state *s)
+{
+	xcb_get_window_attributes_reply_t *attributes =
+		xcb_get_window_attributes_reply(xcb_get(), p->attributes, NULL);
+	xcb_get_geometry_reply_t *geometry =
+		xcb_get_geometry_reply(xcb_get(), p->geometry, NULL);
+	xcb_get_property_reply_t *transient_for =
+		xcb_get_property_reply(xcb_get(), p->transient_for, NULL);
+	xcb_get_property_reply_t *wm_state =
+		xcb_get_property_reply(xcb_get(), p->wm_state, NULL);
+	bool ok = attributes != NULL && geometry != NULL;
+
+	memset(s, 0, sizeof(*s));
+	if (ok) {
+		s->wa.x = geometry->x;
+		s->wa.y = geometry->y;
+		s->wa.width = geometry->width;
+		s->wa.height = geometry->height;
+		s->wa.border_width = geometry->border_width;
+		s->wa.depth = geometry->depth;
+		s->wa.root = geometry->root;
+		s->wa.map_state = attributes->map_state;
+		s->wa.override_redirect = attributes->override_redirect;
+		s->wa.class = attributes->_class;
+		s->wa.your_event_mask = attributes->your_event_mask;
+		s->wa.all_event_masks = attributes->all_event_masks;
+	}
+
+	// Like XGetTransientForHint(), the property only needs to exist.
+	s->is_transient = transient_for != NULL
+			  && transient_for->type == XA_WINDOW
+			  && xcb_get_property_value_length(transient_for) >= 4;
+
+	s->wm_state = -1;
+	if (wm_state != NULL
+	    && wm_state->type == wmatom[WMState]
+	    && xcb_get_property_value_length(wm_state) >= 4) {
+		s->wm_state = *(uint32_t *) xcb_get_property_value(wm_state);
+	}
+
+	free(attributes);
+	free(geometry);
+	free(transient_for);
+	free(wm_state);
+	return ok;
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static xcb_connection_t *xcb_get(void)
+{
+	static xcb_connection_t *xc;
+
+	if (xc == NULL) {
+		xc = XGetXCBConnection(dpy);
+	}
+	return xc;
+}
+
+static xcb_get_property_cookie_t property_request(
+	Window w,
+	Atom property,
+	Atom type,
+	uint32_t length)
+{
+	// Requests on the XCB connection are ordered after all requests Xlib
+	// has queued so far: XCB makes Xlib flush when taking the socket.
+	return xcb_get_property(xcb_get(), 0, w, property, type, 0, length);
+}
+
+static int text_decode(xcb_get_property_reply_t *r, char *text, unsigned int size)
+{
+	if (r == NULL || r->type == XCB_NONE || r->format == 0) {
+		return 0;
+	}
+
+	XTextProperty prop = {
+		.value = xcb_get_property_value(r),
+		.encoding = r->type,
+		.format = r->format,
+		.nitems = xcb_get_property_value_length(r) / (r->format / 8)
+	};
+
+	return dm_textprop_decode(&prop, text, size);
+}
+
+static Atom first_atom(xcb_get_property_reply_t *r)
+{
+	if (r == NULL
+	    || r->type != XA_ATOM
+	    || xcb_get_property_value_length(r) < 4) {
+		return None;
+	}
+	return *(uint32_t *) xcb_get_property_value(r);
+}
+
+// Same decoding as XGetWMNormalHints().
+static bool size_hints_decode(xcb_get_property_reply_t *r, XSizeHints *h)
+{
+	if (r == NULL || r->type != XA_WM_SIZE_HINTS || r->format != 32) {
+		return false;
+	}
+
+	int n = xcb_get_property_value_length(r) / 4;
+	const int32_t *v = xcb_get_property_value(r);
+
+	if (n < SIZE_HINTS_OLD_LENGTH) {
+		return false;
+	}
+
+	*h = (XSizeHints) {
+		.flags = v[0] & (USPosition | USSize | PAllHints | PBaseSize | PWinGravity),
+		.x = v[1],
+		.y = v[2],
+		.width = v[3],
+		.height = v[4],
+		.min_width = v[5],
+		.min_height = v[6],
+		.max_width = v[7],
+		.max_height = v[8],
+		.width_inc = v[9],
+		.height_inc = v[10],
+		.min_aspect = { .x = v[11], .y = v[12] },
+		.max_aspect = { .x = v[13], .y = v[14] },
+	};
+	if (n >= SIZE_HINTS_LENGTH) {
+		h->base_width = v[15];
+		h->base_height = v[16];
+		h->win_gravity = v[17];
+	} else {
+		h->flags &= ~(PBaseSize | PWinGravity);
+	}
+	return true;
+}
+
+// Same decoding as XGetWMHints().
+static bool wm_hints_decode(xcb_get_property_reply_t *r, XWMHints *h)
+{
+	if (r == NULL || r->type != XA_WM_HINTS || r->format != 32) {
+		return false;
+	}
+
+	int n = xcb_get_property_value_length(r) / 4;
+	const int32_t *v = xcb_get_property_value(r);
+
+	if (n < WM_HINTS_LENGTH - 1) {
+		return false;
+	}
+
+	*h = (XWMHints) {
+		.flags = v[0],
+		.input = v[1] ? True : False,
+		.initial_state = v[2],
+		.icon_pixmap = (uint32_t) v[3],
+		.icon_window = (uint32_t) v[4],
+		.icon_x = v[5],
+		.icon_y = v[6],
+		.icon_mask = (uint32_t) v[7],
+	};
+	if (n >= WM_HINTS_LENGTH) {
+		h->window_group = (uint32_t) v[8];
+	} else {
+		h->flags &= ~WindowGroupHint;
+	}
+	return true;
+}
+
+static unsigned int protocols_decode(xcb_get_property_reply_t *r)
+{
+	unsigned int protocols = 0;
+
+	if (r == NULL || r->type != XA_ATOM || r->format != 32) {
+		return 0;
+	}
+
+	int n = xcb_get_property_value_length(r) / 4;
+	const uint32_t *atoms = xcb_get_property_value(r);
+
+	for (int i = 0; i < n; i++) {
+		for (int j = 0; j < WMLast; j++) {
+			if (atoms[i] == wmatom[j]) {
+				protocols |= 1U << j;
+			}
+		}
+	}
+	return protocols;
+}
@@ -0,0 +1,165 @@
+#define _GNU_SOURCE // POSIX_SPAWN_SETSID
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/signalfd.h>
+#include <sys/wait.h>
+
+#include "proc.h"
+
+#include "debug.h"
+#include "dwm.h"
+#include "evloop.h"
+#include "util.h"
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+// Processes waiting for their window. When full, the oldest is forgotten: a
+// process that never maps a window must not hold its slot forever.
+#define SPAWNED_MAX 64
+
+//******************************************************************************
+// Module types
+//******************************************************************************
+struct spawned {
+	pid_t pid; // 0 if the slot is free
+	struct timespec launched;
+	char name[32];
+};
+
+//******************************************************************************
+// Module variables
+//******************************************************************************
+extern char **environ;
+
+static struct spawned spawned[SPAWNED_MAX];
+static unsigned int spawned_next; // Slot to use next, the oldest when full
+static int sigchld_fd = -1;
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static struct spawned *spawned_find(pid_t pid);
+static void sigchld_read(int fd, void *data);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+void proc_init(void)
+{
+	sigset_t mask;
+
+	// Children that exited before are reaped now, there is no signal for
+	// them anymore.
+	while (0 < waitpid(-1, NULL, WNOHANG));
+
+	sigemptyset(&mask);
+	sigaddset(&mask, SIGCHLD);
+	if (sigprocmask(SIG_BLOCK, &mask, NULL) < 0) {
+		die("sigprocmask:");
+	}
+	sigchld_fd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+	if (sigchld_fd < 0) {
+		die("signalfd:");
+	}
+	evloop_fd_add(sigchld_fd, sigchld_read, NULL);
+}
+
+pid_t proc_spawn(char *const argv[])
+{
+	posix_spawnattr_t attr;
+	posix_spawn_file_actions_t actions;
+	sigset_t mask;
+	pid_t pid;
+	int err;
+
+	// posix_spawn() does not copy the address space of the window manager
+	// like fork() would, it only starts the new program.
+	sigemptyset(&mask);
+	posix_spawnattr_init(&attr);
+	posix_spawnattr_setsigmask(&attr, &mask);
+	posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSID);
+	posix_spawn_file_actions_init(&actions);
+	if (dpy != NULL) {
+		posix_spawn_file_actions_addclose(&actions, ConnectionNumber(dpy));
+	}
+	err = posix_spawnp(&pid, argv[0], &actions, &attr, argv, environ);
+	posix_spawn_file_actions_destroy(&actions);
+	posix_spawnattr_destroy(&attr);
+
+	if (err != 0) {
+		fprintf(stderr, "dwm: posix_spawnp %s failed: %s\n", argv[0], strerror(err));
+		return -1;
+	}
+
+	struct spawned *s = &spawned[spawned_next];
+
+	spawned_next = (spawned_next + 1) % SPAWNED_MAX;
+	s->pid = pid;
+	clock_gettime(CLOCK_MONOTONIC, &s->launched);
+	snprintf(s->name, sizeof(s->name), "%s", argv[0]);
+	P_DEBUG("%s: %s, pid %d\n", __func__, argv[0], (int) pid);
+	return pid;
+}
+
+void proc_window_managed(pid_t pid)
+{
+	struct spawned *s;
+	struct timespec now;
+
+	if (pid <= 0 || (s = spawned_find(pid)) == NULL) {
+		return;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	fprintf(stderr, "dwm: %s (pid %d) mapped a window %.1f ms after launch\n",
+		s->name,
+		(int) pid,
+		(now.tv_sec - s->launched.tv_sec) * 1e3
+		+ (now.tv_nsec - s->launched.tv_nsec) / 1e6);
+	s->pid = 0;
+}
+
+void proc_clear(void)
+{
+	if (sigchld_fd >= 0) {
+		evloop_fd_rm(sigchld_fd);
+		close(sigchld_fd);
+	}
+	sigchld_fd = -1;
+	memset(spawned, 0, sizeof(spawned));
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static struct spawned *spawned_find(pid_t pid)
+{
+	for (int i = 0; i < SPAWNED_MAX; i++) {
+		if (spawned[i].pid == pid) {
+			return &spawned[i];
+		}
+	}
+	return NULL;
+}
+
+static void sigchld_read(int fd, void *data)
+{
+	struct signalfd_siginfo info;
+	struct spawned *s;
+	pid_t pid;
+
+	// Signals are merged while pending, one may stand for many children.
+	while (read(fd, &info, sizeof(info)) == sizeof(info));
+	while (0 < (pid = waitpid(-1, NULL, WNOHANG))) {
+		// Exited before mapping a window, or forked it off, like a
+		// launcher does.
+		if ((s = spawned_find(pid)) != NULL) {
+			s->pid = 0;
+		}
+		P_DEBUG("%s: pid %d reaped\n", __func__, (int) pid);
+	}
+}
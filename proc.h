@@ -0,0 +1,36 @@
+#ifndef PROC_H
+#define PROC_H
+
+#include <sys/types.h>
+
+// Child processes: started with posix_spawn(), reaped from the event loop
+// through a signalfd, and remembered until their window is managed, to measure
+// how long an application takes to show up.
+
+//  ----------------------------------------------------------------------------
+/// \brief  Block SIGCHLD and watch for it in the event loop. Must be called
+/// before any child is started.
+//  ----------------------------------------------------------------------------
+void proc_init(void);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Start a program in its own session, without the signal mask of the
+/// window manager.
+/// \param  argv  Program and arguments, NULL terminated. The program is
+/// searched in PATH.
+/// \return The process ID, -1 on failure.
+//  ----------------------------------------------------------------------------
+pid_t proc_spawn(char *const argv[]);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Report the launch to map latency, if a window with that
+/// _NET_WM_PID was started by proc_spawn(). Each process is reported once.
+//  ----------------------------------------------------------------------------
+void proc_window_managed(pid_t pid);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Close the signalfd, and forget the spawned processes.
+//  ----------------------------------------------------------------------------
+void proc_clear(void);
+
+#endif
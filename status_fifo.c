@@ -0,0 +1,90 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "status_fifo.h"
+
+#include "bar.h"
+#include "debug.h"
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+#define LINE_MAX_LENGTH 256 // Same as stext, longer lines are truncated
+
+//******************************************************************************
+// Module variables
+//******************************************************************************
+static int fd = -1;
+static char line[LINE_MAX_LENGTH]; // Line being received
+static size_t line_length;
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+int status_fifo_open(const char *path)
+{
+	if (mkfifo(path, 0600) < 0 && errno != EEXIST) {
+		fprintf(stderr, "dwm: mkfifo %s", path);
+		perror(" failed");
+		return -1;
+	}
+	fd = open(path, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+	if (fd < 0) {
+		fprintf(stderr, "dwm: open %s", path);
+		perror(" failed");
+	}
+	line_length = 0;
+	return fd;
+}
+
+bool status_fifo_read(void)
+{
+	char buf[1024];
+	char status[LINE_MAX_LENGTH];
+	bool has_status = false;
+	ssize_t n;
+
+	while ((n = read(fd, buf, sizeof(buf))) > 0) {
+		for (ssize_t i = 0; i < n; i++) {
+			if (buf[i] == '\n') {
+				memcpy(status, line, line_length);
+				status[line_length] = '\0';
+				has_status = true;
+				line_length = 0;
+			} else if (line_length < sizeof(line) - 1) {
+				line[line_length++] = buf[i];
+			}
+		}
+	}
+
+	// Only the last line matters, earlier ones in the same read would be
+	// replaced before anyone could see them.
+	if (has_status) {
+		bar_status_set(status);
+	}
+
+	if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+		perror("dwm: status fifo read failed");
+		status_fifo_close();
+		return false;
+	}
+	P_DEBUG("%s: partial line of %zu bytes\n", __func__, line_length);
+	return true;
+}
+
+int status_fifo_fd_get(void)
+{
+	return fd;
+}
+
+void status_fifo_close(void)
+{
+	if (fd >= 0) {
+		close(fd);
+	}
+	fd = -1;
+}
@@ -0,0 +1,30 @@
+#ifndef STATUS_FIFO_H
+#define STATUS_FIFO_H
+
+#include <stdbool.h>
+
+// Status text read from a FIFO, as an alternative to setting the root window
+// name. Writers send newline terminated lines, the last complete line read is
+// the status text:
+//	while sleep 0.25; do date; done > /path/to/fifo
+
+//  ----------------------------------------------------------------------------
+/// \brief  Open the FIFO, creating it if it does not exist. It is opened for
+/// reading and writing, so it does not report end of file when the last
+/// writer goes away.
+/// \return The file descriptor to poll, -1 on failure.
+//  ----------------------------------------------------------------------------
+int status_fifo_open(const char *path);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Read what is available without blocking, and set the status text
+/// to the last complete line, if any.
+/// \return False if the FIFO failed and was closed.
+//  ----------------------------------------------------------------------------
+bool status_fifo_read(void);
+
+int status_fifo_fd_get(void);
+
+void status_fifo_close(void);
+
+#endif
@@ -3,12 +3,15 @@
 
 #include "tagview.h"
 
+#include "arrange.h"
 #include "client.h"
 #include "config.h"
 #include "debug.h"
 #include "dwm.h"
+#include "ipc.h"
 #include "layout.h"
 #include "util.h"
+#include "winindex/winindex.h"
 
 //******************************************************************************
 // Module variables
@@ -29,7 +32,7 @@ void tagview_init(void)
 			.index = i,
 			.arrange = LAYOUT_DEFAULT,
 			.layout_cfg = &tagviews[i].layout_cfg_two_cols,
-			.clients = LIST_EMPTY,
+			.clients = LIST_INTRUSIVE(struct Client, tagview_link),
 			.layout_cfg_two_cols = (struct layout_cfg_two_cols) {
 				.n_master = 1,
 				.col_ratio = 0.5,
@@ -41,21 +44,32 @@ void tagview_init(void)
 
 void tagview_hide(struct tagview *tv)
 {
+	struct Client *c;
+
 	if (tv == NULL) {
 		return;
 	}
 	P_DEBUG("%s, clients size: %d\n", __func__, tv->clients.size);
-	list_run_for_all(&tv->clients, client_hide, NULL);
+	TAGVIEW_FOR_EACH_CLIENT(c, tv) {
+		client_hide(c);
+	}
+	tv->mon = NULL;
 }
 
 void tagview_show(struct tagview *tv, struct Monitor *m)
 {
+	struct Client *c;
+
 	if (tv == NULL) {
 		return;
 	}
 	m->tagview = tv;
+	tv->mon = m;
+	ipc_event(IPC_EVENT_TAGVIEW, m->num);
 	tagview_arrange(m);
-	list_run_for_all(&tv->clients, client_show, NULL);
+	TAGVIEW_FOR_EACH_CLIENT(c, tv) {
+		client_show(c);
+	}
 }
 
 void tagview_arrange(struct Monitor *m)
@@ -65,7 +79,10 @@ void tagview_arrange(struct Monitor *m)
 	assert(m->tagview->arrange != NULL);
 	assert(m->tagview->layout_cfg != NULL);
 
-	m->tagview->arrange(m->tagview->layout_cfg, m);
+	struct arrange_txn *txn = arrange_txn_begin(mon_n_clients_get(m));
+
+	m->tagview->arrange(m->tagview->layout_cfg, m, txn);
+	arrange_txn_commit(txn);
 }
 
 void tagview_layout_set(struct tagview *t, enum layout_index layout)
@@ -80,10 +97,7 @@ void tagview_layout_set(struct tagview *t, enum layout_index layout)
 
 bool tagview_has_client(struct tagview *t, struct Client *c)
 {
-	return list_find(
-		&t->clients,
-		client_equal,
-		(struct Client *) c);
+	return c->tagview == t;
 }
 
 void tagview_add_client(struct tagview *t, Client *c)
@@ -91,11 +105,14 @@ void tagview_add_client(struct tagview *t, Client *c)
 	P_DEBUG("%s(%p, %p)\n", __func__, (void *) t, (void *) c);
 
 	list_add_before_selected(&t->clients, c);
+	c->tagview = t;
+	winindex_put(c->win, c, t);
 }
 
 void tagview_rm_client(struct tagview *t, Client *c)
 {
 	P_DEBUG("%s(%p, %p)\n", __func__, (void *) t, (void *) c);
+	assert(c->tagview == t);
 	if (c == list_selected_data_get(&t->clients)) {
 		(void) list_prev_select(&t->clients);
 		if (c == list_selected_data_get(&t->clients)) {
@@ -103,12 +120,16 @@ void tagview_rm_client(struct tagview *t, Client *c)
 		}
 	}
 	list_rm(&t->clients, (void *) c);
+	c->tagview = NULL;
+	winindex_rm(c->win);
 }
 
 void tagview_prepend_client(struct tagview *t, Client *c)
 {
 	P_DEBUG("%s(%p, %p)\n", __func__, (void *) t, (void *) c);
 	list_prepend(&t->clients, c);
+	c->tagview = t;
+	winindex_put(c->win, c, t);
 }
 
 Client *tagview_next_client_select(struct tagview *t)
@@ -129,6 +150,9 @@ Client *tagview_selected_client_get(struct tagview *t)
 
 void tagview_selected_client_set(struct tagview *t, const struct Client *c)
 {
+	// The clients list is intrusive, it cannot tell a client linked in
+	// another tagview from its own.
+	assert(c->tagview == t);
 	list_select(&t->clients, c);
 }
 
@@ -140,36 +164,16 @@ void tagview_run_for_all_tv_all_clients(
 	}
 }
 
-static bool window_to_find_is_client(void *c, void *w)
-{
-	Window *window_to_find = (Window *) w;
-
-	return ((struct Client *) c)->win == *window_to_find;
-}
-
 struct Client *tagviews_find_window_client(Window *w)
 {
-	struct Client *c = NULL;
-	Window *window_to_find = w;
-
-	for (int i = 0; i < LENGTH(tagviews); i++) {
-		c = list_find(
-			&tagviews[i].clients,
-			window_to_find_is_client,
-			window_to_find);
-		if (c != NULL) {
-			return c;
-		}
-	}
-	return NULL;
+	return winindex_client_get(*w);
 }
 
 struct Client *tagview_find_window_client(struct tagview *tv, Window *w)
 {
-	return list_find(
-		&tv->clients,
-		client_has_win,
-		w);
+	const struct winindex_entry *e = winindex_find(*w);
+
+	return (e != NULL && e->tagview == tv) ? e->client : NULL;
 }
 
 struct tagview *tagview_get(unsigned int index)
@@ -29,7 +29,12 @@ struct tagview {
 	void *layout_cfg;
 
 	// This points to the arrange function of the selected layout
-	void (*arrange)(void *layout_cfg, struct Monitor *mon);
+	layout_arrange_function_t arrange;
+
+	// Back-reference to the monitor showing the tagview, NULL if
+	// hidden. Kept up to date by tagview_show()/tagview_hide() and the
+	// monitor module.
+	struct Monitor *mon;
 };
 
 void tagview_init(void);
@@ -48,6 +53,11 @@ void tagview_selected_client_set(struct tagview *t, const struct Client *c);
 
 void tagview_run_for_all_tv_all_clients(void (*callback)(void *data, void *storage));
 
+// Walk the clients of a tagview, in order, c being a struct Client *. The
+// tagview must not change during the walk.
+#define TAGVIEW_FOR_EACH_CLIENT(c, tv) \
+	LIST_FOR_EACH_ENTRY(c, &(tv)->clients, struct Client, tagview_link)
+
 // This searches all tagviews, no parameter needed for tagview to
 // search.
 struct Client *tagviews_find_window_client(Window *w);
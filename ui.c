@@ -4,15 +4,30 @@
 
 #include "bar.h"
 #include "debug.h"
+#include "drag.h"
 #include "dwm.h"
 #include "config.h"
 #include "input.h"
+#include "ipc.h"
+#include "proc.h"
 #include "ui.h"
 #include "util.h"
 
+//******************************************************************************
+// Types
+//******************************************************************************
+// Where a drag started, for the drag_motion_t callbacks.
+struct drag_origin {
+	struct Client *c;
+	int ocx, ocy; // Client position
+	int x, y;     // Pointer position
+};
+
 //******************************************************************************
 // Prototypes
 //******************************************************************************
+static void move_motion(int x, int y, void *data);
+static void resize_motion(int x, int y, void *data);
 
 //******************************************************************************
 // Definitions
@@ -27,7 +42,7 @@ void monitor_focus(const Arg *arg)
 	}
 	client_unfocus(mon_selected_client_get(selmon), false);
 	selmon = target_mon;
-	mon_arrange(target_mon);
+	mon_arrange_schedule(target_mon);
 	client_focus(NULL);
 }
 
@@ -54,15 +69,21 @@ focusstack(const Arg *arg)
 	}
 	if (c) {
 		client_focus(c);
-		restack(selmon);
+		mon_restack_schedule(selmon);
 	}
 }
 
 void
 incnmaster(const Arg *arg)
 {
-	selmon->nmaster = MAX(selmon->nmaster + arg->i, 0);
-	mon_arrange(selmon);
+	struct layout_cfg_two_cols *cfg = &selmon->tagview->layout_cfg_two_cols;
+	int n_master = MAX(cfg->n_master + arg->i, 0);
+
+	if (n_master == cfg->n_master)
+		return;
+	cfg->n_master = n_master;
+	mon_arrange_schedule(selmon);
+	ipc_event(IPC_EVENT_LAYOUT, selmon->num);
 }
 
 void
@@ -88,11 +109,9 @@ killclient(const Arg *arg)
 void
 movemouse(const Arg *arg)
 {
-	int x, y, ocx, ocy, nx, ny;
+	struct drag_origin o;
 	struct Client *c;
 	Monitor *m;
-	XEvent ev;
-	Time lasttime = 0;
 
 	c = mon_selected_client_get(selmon);
 
@@ -100,45 +119,17 @@ movemouse(const Arg *arg)
 		return;
 	if (c->isfullscreen) /* no support moving fullscreen windows by mouse */
 		return;
-	restack(selmon);
-	ocx = c->x;
-	ocy = c->y;
+	mon_restack_schedule(selmon);
+	mon_flush(selmon);
+	o.c = c;
+	o.ocx = c->x;
+	o.ocy = c->y;
 	if (XGrabPointer(dpy, root, False, MOUSEMASK, GrabModeAsync, GrabModeAsync,
 			 None, cursor[CurMove]->cursor, CurrentTime) != GrabSuccess)
 		return;
-	if (!getrootptr(&x, &y))
+	if (!getrootptr(&o.x, &o.y))
 		return;
-	do {
-		XMaskEvent(dpy, MOUSEMASK | ExposureMask | SubstructureRedirectMask, &ev);
-		switch (ev.type) {
-		case ConfigureRequest:
-		case Expose:
-		case MapRequest:
-			xeventhandler(&ev);
-			break;
-		case MotionNotify:
-			if ((ev.xmotion.time - lasttime) <= (1000 / 60))
-				continue;
-			lasttime = ev.xmotion.time;
-
-			nx = ocx + (ev.xmotion.x - x);
-			ny = ocy + (ev.xmotion.y - y);
-			if (abs(selmon->wx - nx) < snap)
-				nx = selmon->wx;
-			else if (abs((selmon->wx + selmon->ww) - (nx + width(c))) < snap)
-				nx = selmon->wx + selmon->ww - width(c);
-			if (abs(selmon->wy - ny) < snap)
-				ny = selmon->wy;
-			else if (abs((selmon->wy + selmon->wh) - (ny + height(c))) < snap)
-				ny = selmon->wy + selmon->wh - height(c);
-			if (!c->isfloating && selmon->tagview->arrange
-			    && (abs(nx - c->x) > snap || abs(ny - c->y) > snap))
-				togglefloating(NULL);
-			if (!selmon->tagview->arrange || c->isfloating)
-				resize(c, nx, ny, c->w, c->h, 1);
-			break;
-		}
-	} while (ev.type != ButtonRelease);
+	drag_run(selmon, move_motion, &o);
 	XUngrabPointer(dpy, CurrentTime);
 	if ((m = recttomon(c->x, c->y, c->w, c->h)) != selmon) {
 		sendmon(c, m);
@@ -156,11 +147,10 @@ quit(const Arg *arg)
 void
 resizemouse(const Arg *arg)
 {
-	int ocx, ocy, nw, nh;
+	struct drag_origin o;
 	struct Client *c;
 	Monitor *m;
 	XEvent ev;
-	Time lasttime = 0;
 
 	c = mon_selected_client_get(selmon);
 
@@ -168,40 +158,16 @@ resizemouse(const Arg *arg)
 		return;
 	if (c->isfullscreen) /* no support resizing fullscreen windows by mouse */
 		return;
-	restack(selmon);
-	ocx = c->x;
-	ocy = c->y;
+	mon_restack_schedule(selmon);
+	mon_flush(selmon);
+	o.c = c;
+	o.ocx = c->x;
+	o.ocy = c->y;
 	if (XGrabPointer(dpy, root, False, MOUSEMASK, GrabModeAsync, GrabModeAsync,
 			 None, cursor[CurResize]->cursor, CurrentTime) != GrabSuccess)
 		return;
 	XWarpPointer(dpy, None, c->win, 0, 0, 0, 0, c->w + c->bw - 1, c->h + c->bw - 1);
-	do {
-		XMaskEvent(dpy, MOUSEMASK | ExposureMask | SubstructureRedirectMask, &ev);
-		switch (ev.type) {
-		case ConfigureRequest:
-		case Expose:
-		case MapRequest:
-			xeventhandler(&ev);
-			break;
-		case MotionNotify:
-			if ((ev.xmotion.time - lasttime) <= (1000 / 60))
-				continue;
-			lasttime = ev.xmotion.time;
-
-			nw = MAX(ev.xmotion.x - ocx - 2 * c->bw + 1, 1);
-			nh = MAX(ev.xmotion.y - ocy - 2 * c->bw + 1, 1);
-			/// Is this only  for snapping at monitor edges?
-			//if (c->mon->wx + nw >= selmon->wx && c->mon->wx + nw <= selmon->wx + selmon->ww
-			//    && c->mon->wy + nh >= selmon->wy && c->mon->wy + nh <= selmon->wy + selmon->wh) {
-			//	if (!c->isfloating && selmon->tagview->arrange
-			//	    && (abs(nw - c->w) > snap || abs(nh - c->h) > snap))
-			//		togglefloating(NULL);
-			//}
-			if (!selmon->tagview->arrange || c->isfloating)
-				resize(c, c->x, c->y, nw, nh, 1);
-			break;
-		}
-	} while (ev.type != ButtonRelease);
+	drag_run(selmon, resize_motion, &o);
 	XWarpPointer(dpy, None, c->win, 0, 0, 0, 0, c->w + c->bw - 1, c->h + c->bw - 1);
 	XUngrabPointer(dpy, CurrentTime);
 	while (XCheckMaskEvent(dpy, EnterWindowMask, &ev));
@@ -234,32 +200,24 @@ void
 setmfact(const Arg *arg)
 {
 	float f;
+	struct layout_cfg_two_cols *cfg = &selmon->tagview->layout_cfg_two_cols;
 
 	if (!arg || !selmon->tagview->arrange)
 		return;
-	f = arg->f < 1.0 ? arg->f + selmon->mfact : arg->f - 1.0;
-	if (f < 0.05 || f > 0.95)
+	f = arg->f < 1.0 ? arg->f + cfg->col_ratio : arg->f - 1.0;
+	if (f < 0.05 || f > 0.95 || f == cfg->col_ratio)
 		return;
-	/// TODO: this must go to the layout config of the current
-	/// tagview instead. Maybe requires a common config format for
-	/// all layouts?
-	selmon->mfact = f;
-	mon_arrange(selmon);
+	/// TODO: the two columns layout is the only one. Other layouts
+	/// may need a common config format for these.
+	cfg->col_ratio = f;
+	mon_arrange_schedule(selmon);
+	ipc_event(IPC_EVENT_LAYOUT, selmon->num);
 }
 
 void
 spawn(const Arg *arg)
 {
-	if (fork() == 0) {
-		/* In the child process */
-		if (dpy)
-			close(ConnectionNumber(dpy));
-		setsid();
-		execvp(((char **) arg->v)[0], (char **) arg->v);
-		fprintf(stderr, "dwm: execvp %s", ((char **) arg->v)[0]);
-		perror(" failed");
-		exit(EXIT_SUCCESS);
-	}
+	proc_spawn((char *const *) arg->v);
 }
 
 void
@@ -273,22 +231,20 @@ tag_send(const Arg *arg)
 
 	struct tagview *dst_tagview = tagview_get(arg->ui);
 
-	tagview_add_client(dst_tagview, c);
+	// Removed first, the tagview lists share the link in the client.
 	tagview_rm_client(selmon->tagview, c);
+	tagview_add_client(dst_tagview, c);
 	client_unfocus(c, true);
 	client_focus(NULL);
-	mon_arrange(selmon);
+	mon_arrange_schedule(selmon);
 
 	////// Somehow, this makes room for the client in the destination
 	////// tagview/monitor, but it does not draw it there.
-	struct Monitor *other_mon = list_find(
-		&mons,
-		mon_shows_tagview,
-		dst_tagview);
+	struct Monitor *other_mon = dst_tagview->mon;
 
 	if (other_mon != NULL) {
 		printf("Tagview is visible, arrange\n");
-		mon_arrange(other_mon);
+		mon_arrange_schedule(other_mon);
 	}
 }
 
@@ -313,8 +269,8 @@ togglebar(const Arg *arg)
 	// Legacy from dwm
 	selmon->showbar = !selmon->showbar;
 	updatebarpos(selmon);
-	XMoveResizeWindow(dpy, selmon->barwin, selmon->wx, selmon->by, selmon->ww, bh);
-	arrange(selmon);
+	XMoveResizeWindow(dpy, selmon->barwin, selmon->wx, selmon->by, selmon->ww, bar_h);
+	mon_arrange_schedule(selmon);
 #endif
 }
 
@@ -373,19 +329,11 @@ toggleview(const Arg *arg)
 	if (newtagset) {
 		selmon->tagset[selmon->seltags] = newtagset;
 		client_focus(NULL);
-		mon_arrange(selmon);
+		mon_arrange_schedule(selmon);
 	}
 }
 
 
-static bool monitor_shows_tagview_index(void *mon, void *index)
-{
-	const struct Monitor *m = (struct Monitor *) mon;
-	int i = *(int *) index;
-
-	return m->tagview->index == i;
-}
-
 void
 tag_view(const Arg *arg)
 {
@@ -396,10 +344,7 @@ tag_view(const Arg *arg)
 	int tv_index = arg->ui;
 
 	P_DEBUG("### %s: finding monitor to swap with\n", __func__);
-	struct Monitor *other_m = list_find(
-		&mons,
-		monitor_shows_tagview_index,
-		&tv_index);
+	struct Monitor *other_m = tagview_get(tv_index)->mon;
 
 	if (config.focus.tagview_change_ignores_mouse_over) {
 		skip_mouse_over_focus_once = true;
@@ -441,11 +386,56 @@ void to_master_send(const Arg *arg)
 	list_data_swap(
 		&selmon->tagview->clients,
 		c,
-		selmon->tagview->clients.head->data);
+		list_data_handle_get(&selmon->tagview->clients, 0));
 	client_focus(c);
-	mon_arrange(selmon);
+	mon_arrange_schedule(selmon);
 }
 
 //******************************************************************************
 // Internal functions
 //******************************************************************************
+static void move_motion(int x, int y, void *data)
+{
+	const struct drag_origin *o = data;
+	struct Client *c = o->c;
+	int nx = o->ocx + (x - o->x);
+	int ny = o->ocy + (y - o->y);
+	int nw = c->w;
+	int nh = c->h;
+
+	if (abs(selmon->wx - nx) < snap)
+		nx = selmon->wx;
+	else if (abs((selmon->wx + selmon->ww) - (nx + width(c))) < snap)
+		nx = selmon->wx + selmon->ww - width(c);
+	if (abs(selmon->wy - ny) < snap)
+		ny = selmon->wy;
+	else if (abs((selmon->wy + selmon->wh) - (ny + height(c))) < snap)
+		ny = selmon->wy + selmon->wh - height(c);
+	if (!c->isfloating && selmon->tagview->arrange
+	    && (abs(nx - c->x) > snap || abs(ny - c->y) > snap))
+		togglefloating(NULL);
+	if ((!selmon->tagview->arrange || c->isfloating)
+	    && applysizehints(c, &nx, &ny, &nw, &nh, 1))
+		client_geom_configure(c, nx, ny, nw, nh);
+}
+
+static void resize_motion(int x, int y, void *data)
+{
+	const struct drag_origin *o = data;
+	struct Client *c = o->c;
+	int nx = c->x;
+	int ny = c->y;
+	int nw = MAX(x - o->ocx - 2 * c->bw + 1, 1);
+	int nh = MAX(y - o->ocy - 2 * c->bw + 1, 1);
+
+	/// Is this only  for snapping at monitor edges?
+	//if (c->mon->wx + nw >= selmon->wx && c->mon->wx + nw <= selmon->wx + selmon->ww
+	//    && c->mon->wy + nh >= selmon->wy && c->mon->wy + nh <= selmon->wy + selmon->wh) {
+	//	if (!c->isfloating && selmon->tagview->arrange
+	//	    && (abs(nw - c->w) > snap || abs(nh - c->h) > snap))
+	//		togglefloating(NULL);
+	//}
+	if ((!selmon->tagview->arrange || c->isfloating)
+	    && applysizehints(c, &nx, &ny, &nw, &nh, 1))
+		client_geom_configure(c, nx, ny, nw, nh);
+}
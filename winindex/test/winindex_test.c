@@ -0,0 +1,265 @@
+// Module under test.
+#include "../winindex.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../linkedlist/linkedlist.h"
+
+//******************************************************************************
+// Module macros
+//******************************************************************************
+// Number of elements in array x.
+#define NB_ELEMENTS(x) (sizeof(x) / sizeof(x[0]))
+
+#define TEST_START_PRINT()    do {                      \
+		printf("Running %s...", __func__);      \
+} while (0)
+
+#define TEST_END_PRINT()  do {                  \
+		printf("OK.\n");                \
+} while (0)
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+// Same as the number of tags in config.h.
+#define BENCH_N_TAGVIEWS 10
+#define BENCH_N_LOOKUPS 1000000
+
+//******************************************************************************
+// Module types
+//******************************************************************************
+// Stand-ins for the window manager types, only their address matters to the
+// index.
+struct Client {
+	Window win;
+};
+
+struct tagview {
+	struct list clients;
+};
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+// Helper functions.
+static Window window_id(int n);
+static double elapsed_ns(const struct timespec *start, const struct timespec *end);
+static bool client_has_win(void *client, void *window);
+
+// Test functions.
+static void test_put_find(void);
+static void test_put_updates(void);
+static void test_rm(void);
+static void test_grow(void);
+
+// Benchmarks.
+static void bench_lookup(int n_clients);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+int main(int argc, char *argv[])
+{
+	if (argc == 2 && strcmp(argv[1], "bench") == 0) {
+		bench_lookup(10);
+		bench_lookup(50);
+		bench_lookup(150);
+		bench_lookup(500);
+		return 0;
+	}
+
+	test_put_find();
+	test_put_updates();
+	test_rm();
+	test_grow();
+	printf("All tests passed.\n");
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static void test_put_find(void)
+{
+	TEST_START_PRINT();
+	struct Client clients[5];
+	struct tagview tv;
+
+	for (int i = 0; i < NB_ELEMENTS(clients); i++) {
+		clients[i].win = window_id(i);
+		winindex_put(clients[i].win, &clients[i], &tv);
+	}
+	assert(winindex_size_get() == NB_ELEMENTS(clients));
+
+	for (int i = 0; i < NB_ELEMENTS(clients); i++) {
+		assert(winindex_client_get(clients[i].win) == &clients[i]);
+		assert(winindex_tagview_get(clients[i].win) == &tv);
+	}
+
+	assert(winindex_find(window_id(100)) == NULL);
+	assert(winindex_client_get(None) == NULL);
+
+	winindex_clear();
+	assert(winindex_size_get() == 0);
+	assert(winindex_find(clients[0].win) == NULL);
+	TEST_END_PRINT();
+}
+
+static void test_put_updates(void)
+{
+	TEST_START_PRINT();
+	struct Client c = { .win = window_id(7) };
+	struct tagview tv_a, tv_b;
+
+	winindex_put(c.win, &c, &tv_a);
+	winindex_put(c.win, &c, &tv_b);
+	assert(winindex_size_get() == 1);
+	assert(winindex_tagview_get(c.win) == &tv_b);
+
+	winindex_clear();
+	TEST_END_PRINT();
+}
+
+static void test_rm(void)
+{
+	TEST_START_PRINT();
+	struct Client clients[200];
+	struct tagview tv;
+
+	for (int i = 0; i < NB_ELEMENTS(clients); i++) {
+		clients[i].win = window_id(i);
+		winindex_put(clients[i].win, &clients[i], &tv);
+	}
+
+	// Remove every other entry, the remaining ones must still be found
+	// whatever the probe sequences looked like.
+	for (int i = 0; i < NB_ELEMENTS(clients); i += 2) {
+		winindex_rm(clients[i].win);
+	}
+	assert(winindex_size_get() == NB_ELEMENTS(clients) / 2);
+
+	for (int i = 0; i < NB_ELEMENTS(clients); i++) {
+		if (i % 2 == 0) {
+			assert(winindex_find(clients[i].win) == NULL);
+		} else {
+			assert(winindex_client_get(clients[i].win) == &clients[i]);
+		}
+	}
+
+	// Removing a window not in the index is harmless.
+	winindex_rm(window_id(1000));
+	assert(winindex_size_get() == NB_ELEMENTS(clients) / 2);
+
+	winindex_clear();
+	TEST_END_PRINT();
+}
+
+static void test_grow(void)
+{
+	TEST_START_PRINT();
+	static struct Client clients[LIST_MAX_SIZE];
+	struct tagview tv;
+
+	for (int i = 0; i < NB_ELEMENTS(clients); i++) {
+		clients[i].win = window_id(i);
+		winindex_put(clients[i].win, &clients[i], &tv);
+	}
+	assert(winindex_size_get() == NB_ELEMENTS(clients));
+
+	for (int i = 0; i < NB_ELEMENTS(clients); i++) {
+		assert(winindex_client_get(clients[i].win) == &clients[i]);
+	}
+
+	winindex_clear();
+	TEST_END_PRINT();
+}
+
+//  ----------------------------------------------------------------------------
+/// \brief  Compare looking windows up with the index, against scanning the
+/// client lists of all tagviews.
+/// \param  n_clients  Number of clients, spread over all tagviews.
+//  ----------------------------------------------------------------------------
+static void bench_lookup(int n_clients)
+{
+	struct tagview tagviews[BENCH_N_TAGVIEWS];
+	struct Client *clients = calloc(n_clients, sizeof(*clients));
+	Window *lookups = malloc(BENCH_N_LOOKUPS * sizeof(*lookups));
+	struct timespec start, end;
+	volatile void *sink;
+
+	for (int i = 0; i < BENCH_N_TAGVIEWS; i++) {
+		tagviews[i].clients = LIST_EMPTY;
+	}
+	for (int i = 0; i < n_clients; i++) {
+		clients[i].win = window_id(i);
+		list_add(&tagviews[i % BENCH_N_TAGVIEWS].clients, &clients[i]);
+		winindex_put(
+			clients[i].win,
+			&clients[i],
+			&tagviews[i % BENCH_N_TAGVIEWS]);
+	}
+	srand(1);
+	for (int i = 0; i < BENCH_N_LOOKUPS; i++) {
+		lookups[i] = window_id(rand() % n_clients);
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < BENCH_N_LOOKUPS; i++) {
+		Window w = lookups[i];
+		void *c = NULL;
+		for (int t = 0; t < BENCH_N_TAGVIEWS && c == NULL; t++) {
+			c = list_find(&tagviews[t].clients, client_has_win, &w);
+		}
+		sink = c;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double scan_ns = elapsed_ns(&start, &end) / BENCH_N_LOOKUPS;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (int i = 0; i < BENCH_N_LOOKUPS; i++) {
+		sink = winindex_client_get(lookups[i]);
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	double index_ns = elapsed_ns(&start, &end) / BENCH_N_LOOKUPS;
+	(void) sink;
+
+	printf("%4d clients: tagview scan %8.1f ns/lookup, index %6.1f ns/lookup\n",
+	       n_clients, scan_ns, index_ns);
+
+	for (int i = 0; i < BENCH_N_TAGVIEWS; i++) {
+		list_destroy(&tagviews[i].clients);
+	}
+	winindex_clear();
+	free(lookups);
+	free(clients);
+}
+
+//------------------------------------------------------------------------------
+// Helper functions
+//------------------------------------------------------------------------------
+
+//  ----------------------------------------------------------------------------
+/// \brief  Make window IDs looking like those of an X server: X clients get
+/// resource ID bases 0x200000 apart, and allocate a few IDs from there.
+//  ----------------------------------------------------------------------------
+static Window window_id(int n)
+{
+	return ((Window) (n / 4 + 1) << 21) | (Window) (3 + 7 * (n % 4));
+}
+
+static double elapsed_ns(const struct timespec *start, const struct timespec *end)
+{
+	return (end->tv_sec - start->tv_sec) * 1e9
+	       + (end->tv_nsec - start->tv_nsec);
+}
+
+static bool client_has_win(void *client, void *window)
+{
+	return ((struct Client *) client)->win == *(Window *) window;
+}
@@ -0,0 +1,165 @@
+#include "winindex.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+//******************************************************************************
+// Module constants
+//******************************************************************************
+// Must be a power of two.
+#define WININDEX_MIN_CAPACITY (64U)
+
+//******************************************************************************
+// Module variables
+//******************************************************************************
+// Open addressing with linear probing. A slot is free when its window is None,
+// which is never a managed client window.
+static struct winindex_entry *slots;
+static unsigned int capacity;
+static int size;
+
+//******************************************************************************
+// Function prototypes
+//******************************************************************************
+static unsigned int slot_index(Window w);
+static struct winindex_entry *slot_find(Window w);
+static void grow(void);
+
+//******************************************************************************
+// Function definitions
+//******************************************************************************
+void winindex_put(Window w, struct Client *c, struct tagview *tv)
+{
+	assert(w != None);
+
+	if (2 * (size + 1) > capacity) {
+		grow();
+	}
+
+	unsigned int i;
+
+	for (i = slot_index(w);
+	     slots[i].win != None && slots[i].win != w;
+	     i = (i + 1) & (capacity - 1)) {
+	}
+
+	if (slots[i].win == None) {
+		size++;
+	}
+	slots[i] = (struct winindex_entry) {
+		.win = w,
+		.client = c,
+		.tagview = tv
+	};
+}
+
+void winindex_rm(Window w)
+{
+	struct winindex_entry *e = slot_find(w);
+
+	if (e == NULL) {
+		return;
+	}
+
+	// Backward shift deletion: move the following entries of the probe
+	// sequence into the hole, so that no tombstones are needed.
+	unsigned int hole = e - slots;
+	unsigned int i = hole;
+
+	for (;;) {
+		i = (i + 1) & (capacity - 1);
+		if (slots[i].win == None) {
+			break;
+		}
+		unsigned int home = slot_index(slots[i].win);
+		// Move the entry only if its home slot is not between the hole
+		// and its current position (cyclically).
+		if (((i - home) & (capacity - 1)) >= ((i - hole) & (capacity - 1))) {
+			slots[hole] = slots[i];
+			hole = i;
+		}
+	}
+	slots[hole] = (struct winindex_entry) { .win = None };
+	size--;
+}
+
+const struct winindex_entry *winindex_find(Window w)
+{
+	return slot_find(w);
+}
+
+struct Client *winindex_client_get(Window w)
+{
+	const struct winindex_entry *e = slot_find(w);
+
+	return e == NULL ? NULL : e->client;
+}
+
+struct tagview *winindex_tagview_get(Window w)
+{
+	const struct winindex_entry *e = slot_find(w);
+
+	return e == NULL ? NULL : e->tagview;
+}
+
+int winindex_size_get(void)
+{
+	return size;
+}
+
+void winindex_clear(void)
+{
+	free(slots);
+	slots = NULL;
+	capacity = 0;
+	size = 0;
+}
+
+//******************************************************************************
+// Internal functions
+//******************************************************************************
+static unsigned int slot_index(Window w)
+{
+	// Fibonacci hashing. X resource IDs of one X client share their high
+	// bits, the multiplication spreads the low bits over the index.
+	return (unsigned int) (((uint64_t) w * UINT64_C(0x9E3779B97F4A7C15)) >> 32)
+	       & (capacity - 1);
+}
+
+static struct winindex_entry *slot_find(Window w)
+{
+	if (size == 0 || w == None) {
+		return NULL;
+	}
+
+	for (unsigned int i = slot_index(w);
+	     slots[i].win != None;
+	     i = (i + 1) & (capacity - 1)) {
+		if (slots[i].win == w) {
+			return &slots[i];
+		}
+	}
+	return NULL;
+}
+
+static void grow(void)
+{
+	struct winindex_entry *old_slots = slots;
+	unsigned int old_capacity = capacity;
+
+	capacity = capacity ? 2 * capacity : WININDEX_MIN_CAPACITY;
+	slots = calloc(capacity, sizeof(*slots));
+	assert(slots);
+	size = 0;
+
+	for (unsigned int i = 0; i < old_capacity; i++) {
+		if (old_slots[i].win != None) {
+			winindex_put(
+				old_slots[i].win,
+				old_slots[i].client,
+				old_slots[i].tagview);
+		}
+	}
+	free(old_slots);
+}
@@ -0,0 +1,52 @@
+#ifndef WININDEX_H
+#define WININDEX_H
+
+#include <stdbool.h>
+#include <X11/X.h>
+
+// Index from X window to the managed client, and the tagview owning that
+// client. This replaces walking the client lists of all tagviews for every X
+// event that carries a window.
+
+struct Client;
+struct tagview;
+
+struct winindex_entry {
+	Window win;
+	struct Client *client;
+	struct tagview *tagview;
+};
+
+//  ----------------------------------------------------------------------------
+/// \brief  Insert the window, or update its client and tagview if the window
+/// is already indexed.
+/// \param  w  Window to index, must not be None.
+/// \param  c  Client managing the window.
+/// \param  tv  Tagview owning the client.
+//  ----------------------------------------------------------------------------
+void winindex_put(Window w, struct Client *c, struct tagview *tv);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Remove the window from the index. Nothing happens if the window is
+/// not indexed.
+//  ----------------------------------------------------------------------------
+void winindex_rm(Window w);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Look the window up.
+/// \return The entry for the window, NULL if not indexed. The entry is only
+/// valid until the next call to winindex_put() or winindex_rm().
+//  ----------------------------------------------------------------------------
+const struct winindex_entry *winindex_find(Window w);
+
+struct Client *winindex_client_get(Window w);
+struct tagview *winindex_tagview_get(Window w);
+
+int winindex_size_get(void);
+
+//  ----------------------------------------------------------------------------
+/// \brief  Remove all entries and free the index storage.
+//  ----------------------------------------------------------------------------
+void winindex_clear(void);
+
+#endif